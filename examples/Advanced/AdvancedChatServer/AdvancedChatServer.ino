@@ -64,8 +64,14 @@ void setup() {
 }
 
 void loop() {
+  // check the state of all links at once
+  EspAtLinksState links = server.poll();
+
   // check for any new client connecting, and say hello (before any incoming data)
-  WiFiClient newClient = server.accept();
+  WiFiClient newClient;
+  if (links.incoming) {
+    newClient = server.accept();
+  }
   if (newClient) {
     for (byte i=0; i < MAX_CLIENTS; i++) {
       if (!clients[i]) {
@@ -83,7 +89,7 @@ void loop() {
 
   // check for incoming data from all clients
   for (byte i=0; i < MAX_CLIENTS; i++) {
-    if (clients[i] && clients[i].available() > 0) {
+    if (clients[i].isReadable(links) && clients[i].available() > 0) {
       // read bytes from a client
       byte buffer[80];
       int count = clients[i].read(buffer, 80);
@@ -98,7 +104,7 @@ void loop() {
 
   // stop any clients which disconnect
   for (byte i=0; i < MAX_CLIENTS; i++) {
-    if (clients[i] && !clients[i].connected()) {
+    if (clients[i] && clients[i].isClosed(links) && !clients[i].connected()) {
       Serial.print("disconnect client #");
       Serial.println(i);
       clients[i].stop();
@@ -0,0 +1,191 @@
+/*
+  This sketch measures the performance of the WiFiEspAT library
+  with the simulated AT firmware, without the ESP module.
+
+  The results are printed as CSV lines for comparison of library versions
+  and settings. Change the simulated UART baud rate and module latency below.
+  For other buffer sizes define WIFIESPAT_CLIENT_RX_BUFFER_SIZE and
+  WIFIESPAT_CLIENT_TX_BUFFER_SIZE in boards.local.txt (see README).
+  With WIFIESPAT_TRAFFIC_STATS defined as 1 in boards.local.txt, the count
+  of AT+CIPSEND and AT+CIPRECVDATA transactions of the TCP tests is printed too.
+  The udp_receive_burst test counts the packets received from a burst
+  of the remote side. Lost packets are missing in the count.
+  The simulator requires more SRAM than an Uno has.
+
+  created in Oct 2024 for WiFiEspAT library
+  by Juraj Andrassy https://github.com/jandrassy
+
+*/
+
+#include <WiFiEspAT.h>
+#include <WiFiEspAtSimulator.h>
+
+const unsigned long SIM_BAUD_RATE = 115200;
+const unsigned long SIM_LATENCY = 1000; // micros
+
+const size_t TCP_DATA_SIZE = 8192;
+const size_t TCP_WRITE_SIZE = 512;
+const size_t MESSAGE_SIZE = 32;
+const int REPEAT_COUNT = 20;
+const uint16_t PORT = 2323;
+const uint8_t UDP_LINK_ID = WIFIESPAT_LINKS_COUNT - 1; // the library takes the highest free link
+const unsigned long UDP_BURST_TIMEOUT = 1000; // millis. lost packets are not waited for
+
+WiFiEspAtSimulator sim(SIM_BAUD_RATE);
+WiFiServer server(PORT);
+uint8_t buff[TCP_WRITE_SIZE];
+
+WiFiClient acceptClient() {
+  sim.remoteConnect(0, PORT);
+  while (true) {
+    WiFiClient client = server.accept();
+    if (client)
+      return client;
+  }
+}
+
+void printResult(const char* test, unsigned long count, unsigned long bytes, unsigned long time, const char* unit) {
+  Serial.print(test);
+  Serial.print(',');
+#ifdef WIFIESPAT1
+  Serial.print("AT1");
+#else
+  Serial.print("AT2");
+#endif
+  Serial.print(',');
+  Serial.print(SIM_BAUD_RATE);
+  Serial.print(',');
+  Serial.print(SIM_LATENCY);
+  Serial.print(',');
+  Serial.print(WIFIESPAT_CLIENT_RX_BUFFER_SIZE);
+  Serial.print(',');
+  Serial.print(WIFIESPAT_CLIENT_TX_BUFFER_SIZE);
+  Serial.print(',');
+  Serial.print(count);
+  Serial.print(',');
+  Serial.print(bytes);
+  Serial.print(',');
+  Serial.print(time);
+  Serial.print(',');
+  // bytes per second for throughput, else operations per second
+  Serial.print((bytes && unit[0] == 'B' ? bytes : count) * 1000000.0 / time, 0);
+  Serial.print(',');
+  Serial.println(unit);
+}
+
+void setup() {
+
+  Serial.begin(115200);
+  while (!Serial);
+
+  sim.setLatency(SIM_LATENCY);
+  WiFi.init(sim);
+
+  if (WiFi.status() == WL_NO_MODULE) {
+    Serial.println("Simulated AT firmware failed!");
+    // don't continue
+    while (true);
+  }
+
+  server.begin();
+
+  Serial.println("test,at,baud,latency,rxbuf,txbuf,count,bytes,micros,rate,unit");
+
+  WiFiClient client = acceptClient();
+#if WIFIESPAT_TRAFFIC_STATS
+  WiFi.resetTrafficStats();
+#endif
+  unsigned long start = micros();
+  for (size_t l = 0; l < TCP_DATA_SIZE; l += TCP_WRITE_SIZE) {
+    client.write(buff, TCP_WRITE_SIZE);
+  }
+  client.flush();
+  unsigned long time = micros() - start;
+  printResult("tcp_upload", 1, sim.remoteReceived(), time, "B/s");
+#if WIFIESPAT_TRAFFIC_STATS
+  printResult("tcp_upload_cipsend", WiFi.trafficStats().total.sendCount, WiFi.trafficStats().total.bytesSent, time, "1/s");
+  WiFi.resetTrafficStats();
+#endif
+
+  start = micros();
+  sim.remoteSend(0, TCP_DATA_SIZE);
+  size_t received = 0;
+  while (received < TCP_DATA_SIZE && client.connected()) {
+    int l = client.read(buff, sizeof(buff));
+    if (l > 0) {
+      received += l;
+    }
+  }
+  time = micros() - start;
+  printResult("tcp_download", 1, received, time, "B/s");
+#if WIFIESPAT_TRAFFIC_STATS
+  printResult("tcp_download_ciprecvdata", WiFi.trafficStats().total.recvCount, WiFi.trafficStats().total.bytesReceived, time, "1/s");
+#endif
+
+  sim.setEcho(true);
+  start = micros();
+  for (int i = 0; i < REPEAT_COUNT; i++) {
+    client.write(buff, MESSAGE_SIZE);
+    client.flush();
+    while (client.available() < (int) MESSAGE_SIZE && client.connected());
+    client.read(buff, MESSAGE_SIZE);
+  }
+  printResult("tcp_request_response", REPEAT_COUNT, REPEAT_COUNT * MESSAGE_SIZE, micros() - start, "1/s");
+  client.stop();
+
+  start = micros();
+  for (int i = 0; i < REPEAT_COUNT; i++) {
+    client.connect("192.168.1.10", 80);
+    client.stop();
+  }
+  printResult("tcp_connect", REPEAT_COUNT, 0, micros() - start, "1/s");
+
+  WiFiUDP udp;
+  udp.begin(PORT);
+  start = micros();
+  for (int i = 0; i < REPEAT_COUNT; i++) {
+    udp.beginPacket("192.168.1.10", PORT);
+    udp.write(buff, MESSAGE_SIZE);
+    udp.endPacket();
+    while (!udp.parsePacket());
+    udp.read(buff, MESSAGE_SIZE);
+  }
+  printResult("udp_request_response", REPEAT_COUNT, REPEAT_COUNT * MESSAGE_SIZE, micros() - start, "1/s");
+  sim.setEcho(false);
+
+  // the remote side sends all packets at once. count is the packets received
+  start = micros();
+  for (int i = 0; i < REPEAT_COUNT; i++) {
+    sim.remoteSend(UDP_LINK_ID, MESSAGE_SIZE);
+  }
+  int packets = 0;
+  size_t bytes = 0;
+  unsigned long lastPacket = millis();
+  time = 0;
+  while (packets < REPEAT_COUNT && millis() - lastPacket < UDP_BURST_TIMEOUT) {
+    int l = udp.parsePacket();
+    if (l > 0) {
+      packets++;
+      bytes += udp.read(buff, sizeof(buff));
+      time = micros() - start;
+      lastPacket = millis();
+    }
+  }
+  printResult("udp_receive_burst", packets, bytes, time, "1/s");
+  udp.stop();
+
+  start = micros();
+  for (int i = 0; i < REPEAT_COUNT; i++) {
+    WiFi.status();
+  }
+  printResult("wifi_status", REPEAT_COUNT, 0, micros() - start, "1/s");
+
+  start = micros();
+  for (int i = 0; i < REPEAT_COUNT; i++) {
+    WiFi.localIP();
+  }
+  printResult("wifi_local_ip", REPEAT_COUNT, 0, micros() - start, "1/s");
+}
+
+void loop() {
+}
@@ -0,0 +1,122 @@
+/*
+  Implementation of the minimal Arduino API for the host build
+*/
+
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void pinMode(uint8_t, uint8_t) {
+}
+
+void digitalWrite(uint8_t, uint8_t) {
+}
+
+char* itoa(int value, char* buffer, int base) {
+  sprintf(buffer, (base == 16) ? "%x" : "%d", value);
+  return buffer;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*buffer++);
+  }
+  return n;
+}
+
+size_t Print::print(const String& s) {
+  return write(s.c_str());
+}
+
+size_t Print::print(long n, int base) {
+  char s[24];
+  sprintf(s, (base == 16) ? "%lX" : "%ld", n);
+  return write(s);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  char s[24];
+  sprintf(s, (base == 16) ? "%lX" : "%lu", n);
+  return write(s);
+}
+
+size_t Print::print(double n, int digits) {
+  char s[48];
+  snprintf(s, sizeof(s), "%.*f", digits, n);
+  return write(s);
+}
+
+int Stream::timedRead() {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if (c >= 0)
+      return c;
+  } while (millis() - start < timeout);
+  return -1;
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+  size_t i = 0;
+  while (i < length) {
+    int c = timedRead();
+    if (c < 0)
+      break;
+    buffer[i++] = c;
+  }
+  return i;
+}
+
+size_t Stream::readBytesUntil(char terminator, char* buffer, size_t length) {
+  size_t i = 0;
+  while (i < length) {
+    int c = timedRead();
+    if (c < 0 || c == terminator)
+      break;
+    buffer[i++] = c;
+  }
+  return i;
+}
+
+bool IPAddress::fromString(const char* address) {
+  unsigned int b[4];
+  char end;
+  if (sscanf(address, "%u.%u.%u.%u%c", &b[0], &b[1], &b[2], &b[3], &end) != 4)
+    return false;
+  for (int i = 0; i < 4; i++) {
+    if (b[i] > 255)
+      return false;
+    bytes[i] = b[i];
+  }
+  return true;
+}
+
+size_t IPAddress::printTo(Print& p) const {
+  size_t n = 0;
+  for (int i = 0; i < 4; i++) {
+    if (i) {
+      n += p.print('.');
+    }
+    n += p.print(bytes[i]);
+  }
+  return n;
+}
+
+const IPAddress INADDR_NONE(0, 0, 0, 0);
+
+HardwareSerial Serial;
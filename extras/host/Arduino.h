@@ -0,0 +1,71 @@
+/*
+  Minimal Arduino API for the host build of the WiFiEspAT library.
+  Only what the library and the Tools examples use.
+*/
+
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <string>
+
+#define PROGMEM
+#define PGM_P const char*
+#define PSTR(s) (s)
+#define F(s) ((const __FlashStringHelper*) (s))
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcpy_P strcpy
+#define memcpy_P memcpy
+#define pgm_read_byte(p) (*(const uint8_t*) (p))
+
+#define DEC 10
+#define HEX 16
+#define LOW 0
+#define HIGH 1
+#define INPUT 0
+#define OUTPUT 1
+
+class __FlashStringHelper;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+char* itoa(int value, char* buffer, int base);
+
+class String {
+public:
+  String(const char* s = "") : s(s) {}
+  const char* c_str() const {return s.c_str();}
+  unsigned int length() const {return s.length();}
+private:
+  std::string s;
+};
+
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+
+// prints to stdout
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  operator bool() {return true;}
+  virtual int available() {return 0;}
+  virtual int read() {return -1;}
+  virtual int peek() {return -1;}
+  virtual size_t write(uint8_t b) {return fwrite(&b, 1, 1, stdout);}
+  virtual size_t write(const uint8_t* buffer, size_t size) {return fwrite(buffer, 1, size, stdout);}
+  using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
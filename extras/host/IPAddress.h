@@ -0,0 +1,26 @@
+#ifndef _HOST_IPADDRESS_H_
+#define _HOST_IPADDRESS_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "Print.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress() {}
+  IPAddress(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) : bytes{b0, b1, b2, b3} {}
+  IPAddress(uint32_t address) {memcpy(bytes, &address, 4);}
+  bool fromString(const char* address);
+  operator uint32_t() const {uint32_t a; memcpy(&a, bytes, 4); return a;}
+  bool operator==(const IPAddress& other) const {return memcmp(bytes, other.bytes, 4) == 0;}
+  bool operator!=(const IPAddress& other) const {return !(*this == other);}
+  uint8_t operator[](int i) const {return bytes[i];}
+  uint8_t& operator[](int i) {return bytes[i];}
+  virtual size_t printTo(Print& p) const;
+private:
+  uint8_t bytes[4] = {0};
+};
+
+extern const IPAddress INADDR_NONE;
+
+#endif
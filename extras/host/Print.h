@@ -0,0 +1,52 @@
+#ifndef _HOST_PRINT_H_
+#define _HOST_PRINT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+class __FlashStringHelper;
+class String;
+class Print;
+
+class Printable {
+public:
+  virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* s) {return s ? write((const uint8_t*) s, strlen(s)) : 0;}
+  size_t write(const char* buffer, size_t size) {return write((const uint8_t*) buffer, size);}
+  virtual int availableForWrite() {return 0;}
+  virtual void flush() {}
+  int getWriteError() {return writeError;}
+  void clearWriteError() {writeError = 0;}
+
+  size_t print(const __FlashStringHelper* s) {return write((const char*) s);}
+  size_t print(const String& s);
+  size_t print(const char* s) {return write(s);}
+  size_t print(char c) {return write((uint8_t) c);}
+  size_t print(unsigned char n, int base = 10) {return print((unsigned long) n, base);}
+  size_t print(int n, int base = 10) {return print((long) n, base);}
+  size_t print(unsigned int n, int base = 10) {return print((unsigned long) n, base);}
+  size_t print(long n, int base = 10);
+  size_t print(unsigned long n, int base = 10);
+  size_t print(double n, int digits = 2);
+  size_t print(const Printable& p) {return p.printTo(*this);}
+
+  size_t println() {return write("\r\n");}
+  template<typename T> size_t println(T v) {return print(v) + println();}
+  template<typename T> size_t println(T v, int base) {return print(v, base) + println();}
+
+protected:
+  void setWriteError(int err = 1) {writeError = err;}
+
+private:
+  int writeError = 0;
+};
+
+#endif
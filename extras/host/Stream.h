@@ -0,0 +1,24 @@
+#ifndef _HOST_STREAM_H_
+#define _HOST_STREAM_H_
+
+#include "Print.h"
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) {this->timeout = timeout;}
+  unsigned long getTimeout() {return timeout;}
+  size_t readBytes(char* buffer, size_t length);
+  size_t readBytes(uint8_t* buffer, size_t length) {return readBytes((char*) buffer, length);}
+  size_t readBytesUntil(char terminator, char* buffer, size_t length);
+  size_t readBytesUntil(char terminator, uint8_t* buffer, size_t length) {return readBytesUntil(terminator, (char*) buffer, length);}
+
+protected:
+  int timedRead();
+  unsigned long timeout = 1000;
+};
+
+#endif
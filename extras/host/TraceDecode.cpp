@@ -0,0 +1,60 @@
+/*
+  Decodes the trace dumped with WiFi.dumpTrace(Serial) on the device.
+  Reads the hex lines from stdin (other lines of the Serial log are skipped)
+  and prints the records like WiFi.printTrace, with the micros since
+  the previous record.
+
+    build/TraceDecode < serial.log
+*/
+
+#include <Arduino.h>
+#include <utility/EspAtDrv.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+static bool parseRecord(const char* line, EspAtTraceRecord& record) {
+  char hex[17];
+  if (sscanf(line, " %16[0-9A-Fa-f]", hex) != 1 || strlen(hex) != 16)
+    return false;
+  for (const char* p = line + strspn(line, " \t") + 16; *p; p++) {
+    if (!isspace((unsigned char) *p))
+      return false;
+  }
+  unsigned long long value = strtoull(hex, nullptr, 16);
+  record.time = (uint32_t) (value >> 32);
+  record.event = (EspAtTraceEvent) ((value >> 24) & 0xFF);
+  record.linkId = (uint8_t) ((value >> 16) & 0xFF);
+  record.arg = (uint16_t) (value & 0xFFFF);
+  return true;
+}
+
+int main() {
+  char line[128];
+  EspAtTraceRecord record;
+  bool first = true;
+  uint32_t previous = 0;
+  while (fgets(line, sizeof(line), stdin)) {
+    if (!parseRecord(line, record))
+      continue;
+    uint32_t delta = first ? 0 : record.time - previous; // unsigned, correct over a micros() overflow
+    first = false;
+    previous = record.time;
+    Serial.print(record.time);
+    Serial.print(F(" +"));
+    Serial.print(delta);
+    Serial.print(' ');
+    Serial.print(EspAtDrvClass::traceEventName(record.event));
+    Serial.print(' ');
+    if (record.linkId == WIFIESPAT_NO_LINK) {
+      Serial.print('-');
+    } else {
+      Serial.print(record.linkId);
+    }
+    Serial.print(' ');
+    Serial.println(record.arg);
+  }
+  fflush(stdout);
+  return 0;
+}
@@ -0,0 +1,167 @@
+/*
+  A session of the library with the AT firmware, for the capture
+  and replay regression test of the host build.
+
+    Session_AT1 capture session_AT1.bin  // with the simulated AT firmware
+    Session_AT1 replay session_AT1.bin  // with the captured AT firmware
+
+  The replay fails if the library sends other bytes than in the capture
+  or if it doesn't play all the records. Capture the session again
+  after an intended change of the communication with the AT firmware.
+*/
+
+#include <Arduino.h>
+#include <WiFiEspAT.h>
+#include <WiFiEspAtCapture.h>
+#include <WiFiEspAtSimulator.h>
+#include <vector>
+
+const uint16_t PORT = 2323;
+const uint8_t CLIENT_LINK_ID = 4; // the first free link
+const uint8_t SERVER_LINK_ID = 0; // incoming link of the simulator
+const uint8_t SECOND_LINK_ID = 1;
+
+class FilePrint : public Print {
+public:
+  FilePrint(FILE* file) : file(file) {}
+  virtual size_t write(uint8_t b) {return fwrite(&b, 1, 1, file);}
+  virtual size_t write(const uint8_t* buffer, size_t size) {return fwrite(buffer, 1, size, file);}
+private:
+  FILE* file;
+};
+
+class MemoryStream : public Stream {
+public:
+  MemoryStream(std::vector<uint8_t>& data) : data(data) {}
+  virtual int available() {return data.size() - pos;}
+  virtual int read() {return (pos < data.size()) ? data[pos++] : -1;}
+  virtual int peek() {return (pos < data.size()) ? data[pos] : -1;}
+  virtual size_t write(uint8_t) {return 0;}
+private:
+  std::vector<uint8_t>& data;
+  size_t pos = 0;
+};
+
+/**
+ * sim is null in replay. the remote side is then in the capture
+ */
+bool session(Stream& serial, WiFiEspAtSimulator* sim) {
+  uint8_t buff[64];
+
+  if (!WiFi.init(serial) || WiFi.status() != WL_CONNECTED)
+    return false;
+  WiFi.localIP();
+
+  WiFiClient client;
+  if (!client.connect("example.com", 80))
+    return false;
+  client.print("GET / HTTP/1.1\r\nHost: example.com\r\n\r\n");
+  client.flush();
+  if (sim) {
+    sim->remoteSend(CLIENT_LINK_ID, 100);
+  }
+  size_t received = 0;
+  while (received < 100 && client.connected()) {
+    int l = client.read(buff, sizeof(buff));
+    if (l > 0) {
+      received += l;
+    }
+  }
+  client.stop();
+
+  WiFiServer server(PORT);
+  server.begin();
+  if (sim) {
+    sim->remoteConnect(SERVER_LINK_ID, PORT);
+    sim->setEcho(true);
+  }
+  WiFiClient incoming = server.accept();
+  if (!incoming)
+    return false;
+  incoming.write(buff, sizeof(buff));
+  incoming.flush();
+  while (incoming.available() < (int) sizeof(buff) && incoming.connected());
+  incoming.read(buff, sizeof(buff));
+
+  WiFiUDP udp;
+  udp.begin(PORT);
+  udp.beginPacket("192.168.1.10", PORT);
+  udp.write(buff, 32);
+  udp.endPacket();
+  while (!udp.parsePacket());
+  udp.read(buff, 32);
+  udp.stop();
+  if (sim) {
+    sim->setEcho(false);
+  }
+
+  // accepted clients idle less than idleTime stay connected
+  server.setIdleLinkPolicy(IDLE_LINK_CLOSE_IDLE, 10000);
+  if (sim) {
+    sim->remoteConnect(SECOND_LINK_ID, PORT);
+  }
+  WiFiClient second = server.accept();
+  if (!second || !incoming.connected())
+    return false;
+  server.setIdleLinkPolicy(IDLE_LINK_CLOSE_IDLE); // idleTime 0 closes nothing
+  server.poll();
+  if (!second.connected() || !incoming.connected())
+    return false;
+  second.stop();
+
+  if (sim) {
+    sim->remoteClose(SERVER_LINK_ID);
+  }
+  while (incoming.connected());
+  incoming.stop();
+
+  // warm start adopts the running server and its accepted connection
+  if (sim) {
+    sim->remoteConnect(SECOND_LINK_ID, PORT);
+  }
+  if (!WiFi.init(serial, -1, true))
+    return false;
+  WiFiServer warmServer(PORT);
+  warmServer.begin();
+  WiFiClient adopted = warmServer.accept();
+  if (!warmServer || !adopted)
+    return false;
+  adopted.stop();
+  warmServer.end();
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc != 3 || (strcmp(argv[1], "capture") && strcmp(argv[1], "replay"))) {
+    fprintf(stderr, "usage: %s capture|replay <file>\n", argv[0]);
+    return 2;
+  }
+  bool capture = !strcmp(argv[1], "capture");
+  FILE* file = fopen(argv[2], capture ? "wb" : "rb");
+  if (!file) {
+    perror(argv[2]);
+    return 2;
+  }
+  bool ok;
+  if (capture) {
+    WiFiEspAtSimulator sim(0);
+    FilePrint out(file);
+    WiFiEspAtCaptureStream captureStream(sim, out);
+    ok = session(captureStream, &sim);
+    captureStream.flush();
+  } else {
+    std::vector<uint8_t> data;
+    int c;
+    while ((c = fgetc(file)) != EOF) {
+      data.push_back(c);
+    }
+    MemoryStream in(data);
+    WiFiEspAtReplayStream replay(in);
+    ok = session(replay, nullptr);
+    printf("mismatches %lu, ended %d\n", replay.mismatches(), replay.ended());
+    ok = ok && !replay.mismatches() && replay.ended();
+  }
+  fclose(file);
+  puts(ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+/*
+  Runs an Arduino sketch on the host. The sketch file is set
+  with -DHOST_SKETCH="path/Sketch.ino" (see CMakeLists.txt).
+  setup() runs once, loop() HOST_LOOP_COUNT times.
+*/
+
+#include <Arduino.h>
+
+#ifndef HOST_LOOP_COUNT
+#define HOST_LOOP_COUNT 1
+#endif
+
+#include HOST_SKETCH
+
+int main() {
+  setup();
+  for (unsigned long i = 0; i < HOST_LOOP_COUNT; i++) {
+    loop();
+  }
+  fflush(stdout);
+  return 0;
+}
@@ -26,12 +26,12 @@ char WiFiClass::ssid[33] = {0};
 char WiFiClass::name[33] = {0}; // hostname
 WiFiApData WiFiClass::apDataInternal[WIFIESPAT_INTERNAL_AP_LIST_SIZE];
 
-bool WiFiClass::init(Stream& serial, int8_t resetPin) {
-  return init(&serial, resetPin);
+bool WiFiClass::init(Stream& serial, int8_t resetPin, bool warmStart) {
+  return init(&serial, resetPin, warmStart);
 }
 
-bool WiFiClass::init(Stream* serial, int8_t resetPin) {
-  bool ok = EspAtDrv.init(serial, resetPin);
+bool WiFiClass::init(Stream* serial, int8_t resetPin, bool warmStart) {
+  bool ok = EspAtDrv.init(serial, resetPin, warmStart);
   state = ok ? WL_IDLE_STATUS : WL_NO_MODULE;
   return ok;
 }
@@ -220,6 +220,45 @@ int8_t WiFiClass::scanNetworks(WiFiApData* _apData, uint8_t _apDataSize) {
   return apDataLength;
 }
 
+bool WiFiClass::startScanNetworks(WiFiApData* _apData, uint8_t _apDataSize, const char* ssid, uint8_t channel) {
+  apData = _apData;
+  apDataSize = _apDataSize;
+  apDataLength = 0;
+  return EspAtDrv.startListAP(addScannedAP, ssid, channel);
+}
+
+bool WiFiClass::startScanNetworks(EspAtApScanCallback callback, const char* ssid, uint8_t channel) {
+  apDataSize = 0;
+  apDataLength = 0;
+  return EspAtDrv.startListAP(callback, ssid, channel);
+}
+
+int8_t WiFiClass::scanComplete() {
+  EspAtDrv.processEvents();
+  if (EspAtDrv.listAPRunning())
+    return WIFI_SCAN_RUNNING;
+  return apDataLength;
+}
+
+/**
+ * keeps the array sorted by RSSI and drops the weakest AP if the array is full
+ */
+void WiFiClass::addScannedAP(const WiFiApData& ap) {
+  uint8_t i = WiFi.apDataLength;
+  if (i == WiFi.apDataSize) {
+    if (i == 0 || ap.rssi <= WiFi.apData[i - 1].rssi)
+      return;
+    i--;
+  } else {
+    WiFi.apDataLength++;
+  }
+  while (i > 0 && WiFi.apData[i - 1].rssi < ap.rssi) {
+    WiFi.apData[i] = WiFi.apData[i - 1];
+    i--;
+  }
+  WiFi.apData[i] = ap;
+}
+
 const char* WiFiClass::SSID(uint8_t index) {
   if (index >= apDataLength)
     return nullptr;
@@ -419,6 +458,60 @@ EspAtDrvError WiFiClass::getLastDriverError() {
   return EspAtDrv.getLastErrorCode();
 }
 
+void WiFiClass::maintain() {
+  EspAtDrv.processEvents();
+}
+
+void WiFiClass::setLinkReuseTime(unsigned long time) {
+  EspAtDrv.setLinkReuseTime(time);
+}
+
+void WiFiClass::setTcpKeepAlive(uint16_t seconds) {
+  EspAtDrv.setTcpKeepAlive(seconds);
+}
+
+#if WIFIESPAT_TRACE_SIZE
+void WiFiClass::printTrace(Print& out) {
+  EspAtDrv.printTrace(out);
+}
+
+void WiFiClass::dumpTrace(Print& out) {
+  EspAtDrv.dumpTrace(out);
+}
+
+void WiFiClass::clearTrace() {
+  EspAtDrv.clearTrace();
+}
+#endif
+
+#if WIFIESPAT_TRAFFIC_STATS
+const EspAtTrafficStats& WiFiClass::trafficStats() {
+  return EspAtDrv.getTrafficStats();
+}
+
+const EspAtLinkStats& WiFiClass::linkStats(uint8_t linkId) {
+  return EspAtDrv.getLinkStats(linkId);
+}
+
+void WiFiClass::resetTrafficStats() {
+  EspAtDrv.resetTrafficStats();
+}
+#endif
+
+#if WIFIESPAT_CMD_STATS
+const EspAtCmdStats& WiFiClass::cmdStats(EspAtCmdType type) {
+  return EspAtDrv.cmdStats(type);
+}
+
+void WiFiClass::resetCmdStats() {
+  EspAtDrv.resetCmdStats();
+}
+
+void WiFiClass::printCmdStats(Print& out) {
+  EspAtDrv.printCmdStats(out);
+}
+#endif
+
 bool WiFiClass::sleepMode(EspAtSleepMode mode) {
   return EspAtDrv.sleepMode(mode);
 }
@@ -45,6 +45,8 @@ enum {
   WL_AP_FAILED
 };
 
+#define WIFI_SCAN_RUNNING (-1) // scanComplete() result as in esp8266 and esp32 WiFi libraries
+
 /* Encryption modes */
 enum wl_enc_type {  /* Values map to 802.11 Cipher Algorithm Identifier */
   ENC_TYPE_WEP  = 5,
@@ -64,8 +66,8 @@ enum wl_enc_type {  /* Values map to 802.11 Cipher Algorithm Identifier */
 class WiFiClass {
 public:
 
-  bool init(Stream& serial, int8_t resetPin = -1);
-  bool init(Stream* serial, int8_t resetPin = -1); // old WiFiEsp lib compatibility
+  bool init(Stream& serial, int8_t resetPin = -1, bool warmStart = false);
+  bool init(Stream* serial, int8_t resetPin = -1, bool warmStart = false); // old WiFiEsp lib compatibility
 
   uint8_t status();
 
@@ -103,6 +105,11 @@ public:
   // enumerate WiFi access points
   int8_t scanNetworks(); // using internal array will occupy a lot of SRAM
   int8_t scanNetworks(WiFiApData* _apData, uint8_t apDataSize); // optional version
+  // scan without waiting. the array gets the apDataSize APs with the best RSSI. optional filter by SSID and channel
+  bool startScanNetworks(WiFiApData* _apData, uint8_t apDataSize, const char* ssid = nullptr, uint8_t channel = 0);
+  // scan without waiting. the callback is invoked for every found AP from WiFi.maintain() or scanComplete()
+  bool startScanNetworks(EspAtApScanCallback callback, const char* ssid = nullptr, uint8_t channel = 0);
+  int8_t scanComplete(); // returns WIFI_SCAN_RUNNING or the count of APs in the array
   const char* SSID(uint8_t index);
   uint8_t encryptionType(uint8_t index);
   uint8_t* BSSID(uint8_t index, uint8_t* bssid);
@@ -153,6 +160,24 @@ public:
   //
   const char* firmwareVersion(char* buffer = fwVersion);
   EspAtDrvError getLastDriverError();
+  void maintain(); // processes notifications from AT firmware and fires the link event callbacks
+  void setLinkReuseTime(unsigned long time); // millis a stopped client's connection stays open for reuse. 0 disables
+  void setTcpKeepAlive(uint16_t seconds); // TCP keep-alive interval for next client connections. 0 disables
+#if WIFIESPAT_TRACE_SIZE
+  void printTrace(Print& out); // prints the trace records, oldest first
+  void dumpTrace(Print& out); // prints the records as hex lines for extras/host TraceDecode
+  void clearTrace();
+#endif
+#if WIFIESPAT_TRAFFIC_STATS
+  const EspAtTrafficStats& trafficStats(); // counters of all links
+  const EspAtLinkStats& linkStats(uint8_t linkId); // counters of firmware's link 0 to 4
+  void resetTrafficStats();
+#endif
+#if WIFIESPAT_CMD_STATS
+  const EspAtCmdStats& cmdStats(EspAtCmdType type); // latency of AT commands of the type
+  void resetCmdStats();
+  void printCmdStats(Print& out); // one line for every used command type
+#endif
 
   bool sleepMode(EspAtSleepMode mode);
   bool deepSleep();
@@ -160,6 +185,7 @@ public:
 
 private:
   uint8_t mapAtEnc2ArduinoEnc(uint8_t encryptionType);
+  static void addScannedAP(const WiFiApData& ap);
 
   uint8_t state = WL_NO_MODULE;
 
@@ -35,7 +35,7 @@ int WiFiClient::connect(bool ssl, const char* host, uint16_t port) {
   if (stream) {
     stop();
   }
-  uint8_t linkId = EspAtDrv.connect(ssl ? "SSL" : "TCP", host, port);
+  uint8_t linkId = ssl ? EspAtDrv.connectSSL(host, port, sslConfig) : EspAtDrv.connect("TCP", host, port);
   if (linkId == NO_LINK)
     return false;
   stream = WiFiEspAtBuffManager.getBuffStream(linkId, WIFIESPAT_CLIENT_RX_BUFFER_SIZE, WIFIESPAT_CLIENT_TX_BUFFER_SIZE);
@@ -160,6 +160,34 @@ uint8_t WiFiClient::status() {
   return CLOSED;
 }
 
+bool WiFiClient::isReadable(const EspAtLinksState& state) {
+  if (!stream)
+    return false;
+  if (stream->buffered())
+    return true;
+  uint8_t linkId = stream->getLinkId();
+  return linkId != NO_LINK && (state.readable & (1 << (linkId & INDEX_MASK)));
+}
+
+bool WiFiClient::isClosed(const EspAtLinksState& state) {
+  if (!stream)
+    return true;
+  uint8_t linkId = stream->getLinkId();
+  return linkId == NO_LINK || (state.closed & (1 << (linkId & INDEX_MASK)));
+}
+
+bool WiFiClient::onEvent(EspAtLinkEventCallback callback) {
+  if (!stream || stream->getLinkId() == NO_LINK)
+    return false;
+  return EspAtDrv.setLinkEventCallback(stream->getLinkId(), callback);
+}
+
+uint8_t WiFiClient::linkId() {
+  if (!stream)
+    return NO_LINK;
+  return stream->getLinkId();
+}
+
 IPAddress WiFiClient::remoteIP() {
   IPAddress ip;
   uint16_t port = 0;
@@ -52,6 +52,7 @@ public:
   virtual int connect(const char *host, uint16_t port);
   int connectSSL(IPAddress ip, uint16_t port);
   int connectSSL(const char *host, uint16_t port);
+  void setSSLConfig(const EspAtSslConfig* config) {sslConfig = config;} // applied by connectSSL. must stay valid
   virtual void stop();
           void abort();
 
@@ -71,6 +72,14 @@ public:
   virtual uint8_t connected();
   uint8_t status();
 
+  // evaluate the state from WiFiServer.poll() without querying the AT firmware
+  bool isReadable(const EspAtLinksState& state);
+  bool isClosed(const EspAtLinksState& state);
+
+  // the callback is fired from WiFi.maintain(). linkId identifies the client
+  bool onEvent(EspAtLinkEventCallback callback);
+  uint8_t linkId();
+
   // remoteIP and the ports are not stored
   // every call to these functions retrieves the value from AT firmware
   IPAddress remoteIP();
@@ -84,6 +93,7 @@ private:
   int connect(bool ssl, const char *host, uint16_t port);
 
   WiFiEspAtSharedBuffStreamPtr stream;
+  const EspAtSslConfig* sslConfig = nullptr;
 
 };
 
@@ -21,61 +21,60 @@
 #include "utility/EspAtDrvLogging.h"
 #include "utility/EspAtDrv.h"
 
+const uint8_t BUFFERS_COUNT = 2 * WIFIESPAT_BUFF_STREAMS_COUNT;
+
 WiFiEspAtBuffManagerClass::WiFiEspAtBuffManagerClass() {
-  for (int i = 0; i < WIFIESPAT_LINKS_COUNT; i++) {
+  for (int i = 0; i < WIFIESPAT_BUFF_STREAMS_COUNT; i++) {
     pool[i] = nullptr;
   }
 }
 
 WiFiEspAtBuffStream* WiFiEspAtBuffManagerClass::getBuffStream(uint8_t linkId, size_t rxBufferSize, size_t txBufferSize) {
 
-  int freePos = -1;
-
-  for (int i = 0; i < WIFIESPAT_LINKS_COUNT; i++) {
-    if (pool[i] == nullptr) {
-      freePos = i;
+  int pos = -1;
+  for (int i = 0; i < WIFIESPAT_BUFF_STREAMS_COUNT; i++) {
+    if (pool[i] == nullptr || !pool[i]->serialId) {
+      pos = i;
       break;
     }
-    if (pool[i]->serialId)
-      continue;
-    if (pool[i]->rxBufferSize == rxBufferSize && pool[i]->txBufferSize == txBufferSize) {
-      pool[i]->linkId = linkId;
-      pool[i]->serialId = nextSerialId();
-      LOG_INFO_PRINT_PREFIX();
-      LOG_INFO_PRINT(F("BuffManager returned buff.stream id "));
-      LOG_INFO_PRINT(serialId);
-      LOG_INFO_PRINT(F(" at index "));
-      LOG_INFO_PRINT(i);
-      if (linkId != WIFIESPAT_NO_LINK) {
-        LOG_INFO_PRINT(F(" for linkId "));
-        LOG_INFO_PRINT(linkId & INDEX_MASK);
-      }
-      LOG_INFO_PRINTLN();
-      return pool[i];
-    }
   }
-  if (freePos == -1) {
+  if (pos == -1) {
     LOG_WARN_PRINT_PREFIX();
     LOG_WARN_PRINTLN(F("getBuffStream no free position"));
     return nullptr;
   }
-  WiFiEspAtBuffStream *res = new WiFiEspAtBuffStream();
+
+  uint8_t* rxBuffer = nullptr;
   if (rxBufferSize) {
-    res->rxBuffer = new uint8_t[rxBufferSize];
+    rxBuffer = getBuffer(rxBufferSize);
+    if (rxBuffer == nullptr)
+      return nullptr;
   }
+  uint8_t* txBuffer = nullptr;
   if (txBufferSize) {
-    res->txBuffer = new uint8_t[txBufferSize];
+    txBuffer = getBuffer(txBufferSize);
+    if (txBuffer == nullptr) {
+      releaseBuffer(rxBuffer);
+      return nullptr;
+    }
+  }
+
+  bool isNew = (pool[pos] == nullptr);
+  if (isNew) {
+    pool[pos] = new WiFiEspAtBuffStream();
   }
+  WiFiEspAtBuffStream* res = pool[pos];
+  res->rxBuffer = rxBuffer;
   res->rxBufferSize = rxBufferSize;
+  res->txBuffer = txBuffer;
   res->txBufferSize = txBufferSize;
   res->linkId = linkId;
   res->serialId = nextSerialId();
-  pool[freePos] = res;
   LOG_INFO_PRINT_PREFIX();
-  LOG_INFO_PRINT(F("BuffManager new buff.stream id "));
+  LOG_INFO_PRINT(isNew ? F("BuffManager new buff.stream id ") : F("BuffManager returned buff.stream id "));
   LOG_INFO_PRINT(serialId);
   LOG_INFO_PRINT(F(" at index "));
-  LOG_INFO_PRINT(freePos);
+  LOG_INFO_PRINT(pos);
   if (linkId != WIFIESPAT_NO_LINK) {
     LOG_INFO_PRINT(F(" for linkId "));
     LOG_INFO_PRINT(linkId & INDEX_MASK);
@@ -88,45 +87,124 @@ WiFiEspAtBuffStream* WiFiEspAtBuffManagerClass::getBuffStream(uint8_t linkId, si
 }
 
 void WiFiEspAtBuffManagerClass::freeUnused() {
-  for (int i = 0; i < WIFIESPAT_LINKS_COUNT; i++) {
-    if (pool[i] == nullptr)
-      break;
-    if (pool[i]->linkId == WIFIESPAT_NO_LINK) {
-      LOG_INFO_PRINT_PREFIX();
-      LOG_INFO_PRINT(F("BuffManager free tx "));
-      LOG_INFO_PRINTLN(pool[i]->txBufferSize);
-      if (pool[i]->rxBuffer != nullptr) {
-        delete pool[i]->rxBuffer;
-      }
-      if (pool[i]->txBuffer != nullptr) {
-        delete pool[i]->txBuffer;
-      }
+  for (int i = 0; i < WIFIESPAT_BUFF_STREAMS_COUNT; i++) {
+    if (pool[i] != nullptr && !pool[i]->serialId) {
       delete pool[i];
       pool[i] = nullptr;
     }
   }
   int i = 0;
-  for (; i < WIFIESPAT_LINKS_COUNT && pool[i] != nullptr; i++);
+  for (; i < WIFIESPAT_BUFF_STREAMS_COUNT && pool[i] != nullptr; i++);
   int j = i;
-  for (; i < WIFIESPAT_LINKS_COUNT; i++) {
+  for (; i < WIFIESPAT_BUFF_STREAMS_COUNT; i++) {
     if (pool[i] != nullptr) {
       pool[j++] = pool[i];
       pool[i] = nullptr;
     }
   }
+  for (int b = 0; b < BUFFERS_COUNT; b++) {
+    Buffer& buff = buffers[b];
+    if (buff.data != nullptr && !buff.used) {
+      LOG_INFO_PRINT_PREFIX();
+      LOG_INFO_PRINT(F("BuffManager free buffer "));
+      LOG_INFO_PRINTLN(buff.size);
+      delete[] buff.data;
+      buff.data = nullptr;
+      buff.size = 0;
+    }
+  }
+}
+
+void WiFiEspAtBuffManagerClass::flush(uint8_t linkId) {
+  for (int i = 0; i < WIFIESPAT_BUFF_STREAMS_COUNT; i++) {
+    if (pool[i] != nullptr && pool[i]->serialId && pool[i]->linkId == linkId) {
+      pool[i]->flush();
+    }
+  }
 }
 
 uint8_t WiFiEspAtBuffManagerClass::nextSerialId() {
   while (true) {
     serialId++;
+    if (!serialId)
+      continue; // 0 is 'free'
     int i = 0;
-    for (; i < WIFIESPAT_LINKS_COUNT; i++) {
+    for (; i < WIFIESPAT_BUFF_STREAMS_COUNT; i++) {
       if (pool[i] == nullptr || pool[i]->serialId == serialId)
         break;
     }
-    if (i == WIFIESPAT_LINKS_COUNT || pool[i] == nullptr)
+    if (i == WIFIESPAT_BUFF_STREAMS_COUNT || pool[i] == nullptr)
       return serialId;
   }
 }
 
+/**
+ * returns a not used buffer of the requested size. if there is no such buffer,
+ * a new one is allocated. if there is no place for a new buffer,
+ * the smallest not used larger buffer is returned.
+ */
+uint8_t* WiFiEspAtBuffManagerClass::getBuffer(size_t size) {
+  int freePos = -1;
+  int largerPos = -1;
+  for (int i = 0; i < BUFFERS_COUNT; i++) {
+    Buffer& buff = buffers[i];
+    if (buff.data == nullptr) {
+      if (freePos == -1) {
+        freePos = i;
+      }
+      continue;
+    }
+    if (buff.used || buff.size < size)
+      continue;
+    if (buff.size == size) {
+      buff.used = true;
+      return buff.data;
+    }
+    if (largerPos == -1 || buff.size < buffers[largerPos].size) {
+      largerPos = i;
+    }
+  }
+  if (freePos != -1) {
+    uint8_t* data = new uint8_t[size];
+    if (data != nullptr) {
+      Buffer& buff = buffers[freePos];
+      buff.data = data;
+      buff.size = size;
+      buff.used = true;
+      LOG_INFO_PRINT_PREFIX();
+      LOG_INFO_PRINT(F("BuffManager new buffer "));
+      LOG_INFO_PRINTLN(size);
+      return data;
+    }
+  }
+  if (largerPos != -1) {
+    buffers[largerPos].used = true;
+    return buffers[largerPos].data;
+  }
+  LOG_WARN_PRINT_PREFIX();
+  LOG_WARN_PRINT(F("BuffManager no buffer for size "));
+  LOG_WARN_PRINTLN(size);
+  return nullptr;
+}
+
+void WiFiEspAtBuffManagerClass::releaseBuffer(uint8_t* data) {
+  if (data == nullptr)
+    return;
+  for (int i = 0; i < BUFFERS_COUNT; i++) {
+    if (buffers[i].data == data) {
+      buffers[i].used = false;
+      return;
+    }
+  }
+}
+
+void WiFiEspAtBuffManagerClass::releaseBuffers(WiFiEspAtBuffStream* stream) {
+  releaseBuffer(stream->rxBuffer);
+  stream->rxBuffer = nullptr;
+  stream->rxBufferSize = 0;
+  releaseBuffer(stream->txBuffer);
+  stream->txBuffer = nullptr;
+  stream->txBufferSize = 0;
+}
+
 WiFiEspAtBuffManagerClass WiFiEspAtBuffManager;
@@ -22,6 +22,11 @@
 
 #include "WiFiEspAtBuffStream.h"
 
+// a UDP object can hold a RX and a TX stream at the same time
+#ifndef WIFIESPAT_BUFF_STREAMS_COUNT
+#define WIFIESPAT_BUFF_STREAMS_COUNT (WIFIESPAT_LINKS_COUNT + 2)
+#endif
+
 class WiFiEspAtBuffManagerClass {
 public:
 
@@ -30,13 +35,29 @@ public:
   WiFiEspAtBuffStream* getBuffStream(uint8_t linkId, size_t rxBufferSize, size_t txBufferSize);
 
   void freeUnused();
+  void flush(uint8_t linkId); // sends buffered data of streams of the link
 
 private:
+  friend class WiFiEspAtBuffStream;
 
-  WiFiEspAtBuffStream* pool[WIFIESPAT_LINKS_COUNT];
+  // RX and TX buffers are pooled separately from the streams
+  // and are handed out by size, so any stream can be combined
+  // with any free buffers of the requested sizes
+  struct Buffer {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    bool used = false;
+  };
+
+  WiFiEspAtBuffStream* pool[WIFIESPAT_BUFF_STREAMS_COUNT];
+  Buffer buffers[2 * WIFIESPAT_BUFF_STREAMS_COUNT];
   uint8_t serialId = 0;
 
   uint8_t nextSerialId();
+
+  uint8_t* getBuffer(size_t size);
+  void releaseBuffer(uint8_t* data);
+  void releaseBuffers(WiFiEspAtBuffStream* stream);
 };
 
 extern WiFiEspAtBuffManagerClass WiFiEspAtBuffManager;
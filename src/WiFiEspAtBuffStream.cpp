@@ -19,6 +19,7 @@
 
 #include <Arduino.h>
 #include "WiFiEspAtBuffStream.h"
+#include "WiFiEspAtBuffManager.h"
 #include "utility/EspAtDrv.h"
 #include "utility/EspAtDrvLogging.h"
 
@@ -56,6 +57,7 @@ void WiFiEspAtBuffStream::free() {
   rxBufferIndex = 0;
   txBufferLength = 0;
   udpPort = 0;
+  WiFiEspAtBuffManager.releaseBuffers(this);
 }
 
 void WiFiEspAtBuffStream::close(bool abort) {
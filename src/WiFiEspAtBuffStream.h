@@ -46,6 +46,7 @@ public:
   int8_t getWriteError() {return writeError;}
 
   int available();
+  size_t buffered() {return rxBufferLength - rxBufferIndex;}
   int read();
   int read(uint8_t *buf, size_t size);
   int peek();
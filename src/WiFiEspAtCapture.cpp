@@ -0,0 +1,113 @@
+/*
+  This file is part of the WiFiEspAT library for Arduino
+  https://github.com/jandrassy/WiFiEspAT
+  Copyright 2024 Juraj Andrassy
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "WiFiEspAtCapture.h"
+
+int WiFiEspAtCaptureStream::read() {
+  int b = serial.read();
+  if (b != -1) {
+    add(CAPTURE_RX, b);
+  }
+  return b;
+}
+
+size_t WiFiEspAtCaptureStream::write(uint8_t b) {
+  add(CAPTURE_TX, b);
+  return serial.write(b);
+}
+
+size_t WiFiEspAtCaptureStream::write(const uint8_t* buffer, size_t size) {
+  size_t n = serial.write(buffer, size);
+  for (size_t i = 0; i < n; i++) {
+    add(CAPTURE_TX, buffer[i]);
+  }
+  return n;
+}
+
+void WiFiEspAtCaptureStream::flush() {
+  writeRecord();
+  serial.flush();
+}
+
+void WiFiEspAtCaptureStream::add(uint8_t dir, uint8_t b) {
+  if (dir != direction || length == sizeof(buffer)) {
+    writeRecord();
+    direction = dir;
+    start = micros();
+  }
+  buffer[length++] = b;
+}
+
+void WiFiEspAtCaptureStream::writeRecord() {
+  if (!length)
+    return;
+  uint8_t header[CAPTURE_HEADER_SIZE];
+  header[0] = direction;
+  for (uint8_t i = 0; i < 4; i++) {
+    header[1 + i] = (start >> (8 * i)) & 0xFF;
+  }
+  header[5] = length;
+  out.write(header, CAPTURE_HEADER_SIZE);
+  out.write(buffer, length);
+  length = 0;
+}
+
+bool WiFiEspAtReplayStream::nextRecord() {
+  if (left)
+    return true;
+  if (capture.available() < CAPTURE_HEADER_SIZE)
+    return false;
+  direction = capture.read();
+  for (uint8_t i = 0; i < 4; i++) { // timestamp
+    capture.read();
+  }
+  left = capture.read();
+  return left || nextRecord(); // skip empty record
+}
+
+int WiFiEspAtReplayStream::available() {
+  if (!nextRecord() || direction != CAPTURE_RX)
+    return 0;
+  return left;
+}
+
+int WiFiEspAtReplayStream::read() {
+  if (!available())
+    return -1;
+  left--;
+  return capture.read();
+}
+
+int WiFiEspAtReplayStream::peek() {
+  if (!available())
+    return -1;
+  return capture.peek();
+}
+
+size_t WiFiEspAtReplayStream::write(uint8_t b) {
+  if (nextRecord() && direction == CAPTURE_TX) {
+    left--;
+    if (capture.read() != b) {
+      mismatchCount++;
+    }
+  } else { // the library sends more than it did in the capture
+    mismatchCount++;
+  }
+  return 1;
+}
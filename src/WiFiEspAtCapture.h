@@ -0,0 +1,88 @@
+/*
+  This file is part of the WiFiEspAT library for Arduino
+  https://github.com/jandrassy/WiFiEspAT
+  Copyright 2024 Juraj Andrassy
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _WIFIESPAT_CAPTURE_H_
+#define _WIFIESPAT_CAPTURE_H_
+
+#include <Arduino.h>
+
+/*
+ * Capture record: 'T' (to firmware) or 'R' (from firmware),
+ * 4 bytes micros of the first byte (little endian), 1 byte length, the bytes
+ */
+const uint8_t CAPTURE_TX = 'T';
+const uint8_t CAPTURE_RX = 'R';
+const uint8_t CAPTURE_HEADER_SIZE = 6;
+
+/**
+ * Wraps the Serial of the AT firmware and writes all bytes
+ * sent and read by the library as capture records to `out`.
+ * Use it in WiFi.init instead of the Serial.
+ */
+class WiFiEspAtCaptureStream : public Stream {
+public:
+  WiFiEspAtCaptureStream(Stream& serial, Print& out) : serial(serial), out(out) {}
+
+  virtual int available() {return serial.available();}
+  virtual int read();
+  virtual int peek() {return serial.peek();}
+  virtual size_t write(uint8_t b);
+  virtual size_t write(const uint8_t* buffer, size_t size); // passes bulk writes to the serial
+  virtual void flush(); // writes the pending record
+
+private:
+  Stream& serial;
+  Print& out;
+  uint8_t direction = 0;
+  unsigned long start;
+  uint8_t buffer[32]; // bytes of the pending record
+  uint8_t length = 0;
+
+  void add(uint8_t dir, uint8_t b);
+  void writeRecord();
+};
+
+/**
+ * Plays a capture back to the library in place of the Serial of the AT firmware.
+ * Bytes of a 'R' record are available only after the library wrote
+ * all bytes of the preceding 'T' records. The written bytes are compared
+ * with the 'T' records. The timestamps are not used.
+ */
+class WiFiEspAtReplayStream : public Stream {
+public:
+  WiFiEspAtReplayStream(Stream& capture) : capture(capture) {}
+
+  virtual int available();
+  virtual int read();
+  virtual int peek();
+  virtual size_t write(uint8_t b);
+
+  bool ended() {return !nextRecord();} // all records were played
+  unsigned long mismatches() {return mismatchCount;} // written bytes different from the capture
+
+private:
+  Stream& capture;
+  uint8_t direction = 0;
+  uint8_t left = 0; // bytes of the current record
+  unsigned long mismatchCount = 0;
+
+  bool nextRecord();
+};
+
+#endif
@@ -65,4 +65,14 @@
 #endif
 #endif
 
+// AT1 UDP listener queue for messages received while the previous message is not read
+// each message takes its size + 8 bytes. 0 disables the queue
+#ifndef WIFIESPAT_UDP_RX_QUEUE_SIZE
+#if defined(__AVR__) && RAMEND <= 0x8FF
+#define WIFIESPAT_UDP_RX_QUEUE_SIZE 0
+#else
+#define WIFIESPAT_UDP_RX_QUEUE_SIZE 512
+#endif
+#endif
+
 #endif
@@ -0,0 +1,431 @@
+/*
+  This file is part of the WiFiEspAT library for Arduino
+  https://github.com/jandrassy/WiFiEspAT
+  Copyright 2024 Juraj Andrassy
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "WiFiEspAtSimulator.h"
+
+const char REMOTE_IP[] = "\"192.168.1.10\"";
+
+bool WiFiEspAtSimulator::setResponse(const char* command, const char* response) {
+  if (scriptLength == SIM_SCRIPT_SIZE)
+    return false;
+  script[scriptLength].command = command;
+  script[scriptLength].response = response;
+  scriptLength++;
+  return true;
+}
+
+bool WiFiEspAtSimulator::remoteConnect(uint8_t linkId, uint16_t localPort, uint16_t remotePort) {
+  if (linkId >= WIFIESPAT_LINKS_COUNT || links[linkId].open)
+    return false;
+  links[linkId].open = true;
+  links[linkId].udp = false;
+  links[linkId].incoming = true;
+  links[linkId].remotePort = remotePort;
+  links[linkId].localPort = localPort;
+  links[linkId].available = 0;
+  if (linkConnInfo) {
+    reply("+LINK_CONN:0,");
+    reply((long) linkId);
+    reply(",\"TCP\",1,");
+    reply(REMOTE_IP);
+    reply((uint8_t) ',');
+    reply((long) remotePort);
+    reply((uint8_t) ',');
+    reply((long) localPort);
+  } else {
+    reply((long) linkId);
+    reply(",CONNECT");
+  }
+  reply("\r\n");
+  return true;
+}
+
+bool WiFiEspAtSimulator::remoteSend(uint8_t linkId, size_t length) {
+  if (linkId >= WIFIESPAT_LINKS_COUNT || !links[linkId].open || !length)
+    return false;
+#ifndef WIFIESPAT1
+  if (links[linkId].udp) { // the firmware keeps the datagrams apart
+    if (udpPacketsCount == SIM_UDP_PACKETS || length > 0xFFFF)
+      return false;
+    udpPackets[udpPacketsCount].linkId = linkId;
+    udpPackets[udpPacketsCount].length = length;
+    udpPacketsCount++;
+  }
+#endif
+  reply("+IPD,");
+  reply((long) linkId);
+  reply((uint8_t) ',');
+  reply((long) length);
+#ifdef WIFIESPAT1
+  if (links[linkId].udp && links[linkId].localPort) { // AT1 UDP listener gets the data pushed
+    if (dataInfo) {
+      reply((uint8_t) ',');
+      reply(REMOTE_IP);
+      reply((uint8_t) ',');
+      reply((long) links[linkId].remotePort);
+    }
+    reply((uint8_t) ':');
+    replyData(length);
+    reply("\r\n");
+    return true;
+  }
+#endif
+  reply("\r\n");
+  links[linkId].available += length;
+  return true;
+}
+
+bool WiFiEspAtSimulator::remoteClose(uint8_t linkId) {
+  if (linkId >= WIFIESPAT_LINKS_COUNT || !links[linkId].open)
+    return false;
+  links[linkId].open = false;
+  links[linkId].available = 0;
+  dropUdpPackets(linkId);
+  reply((long) linkId);
+  reply(",CLOSED\r\n");
+  return true;
+}
+
+int WiFiEspAtSimulator::available() {
+  if (!outLength)
+    return 0;
+  long elapsed = (long) (micros() - paceStart);
+  if (elapsed < 0)
+    return 0;
+  if (!byteTime)
+    return outLength;
+  size_t allowed = elapsed / byteTime + 1;
+  if (allowed <= paced)
+    return 0;
+  allowed -= paced;
+  return (allowed < outLength) ? allowed : outLength;
+}
+
+int WiFiEspAtSimulator::read() {
+  if (!available())
+    return -1;
+  uint8_t b = out[outIndex];
+  outIndex = (outIndex + 1) % WIFIESPAT_SIM_BUFFER_SIZE;
+  outLength--;
+  paced++;
+  return b;
+}
+
+int WiFiEspAtSimulator::peek() {
+  if (!available())
+    return -1;
+  return out[outIndex];
+}
+
+size_t WiFiEspAtSimulator::write(uint8_t b) {
+  if (byteTime) { // UART speed
+    while (micros() - lastWrite < byteTime);
+    lastWrite = micros();
+  }
+  if (sendLinkId != WIFIESPAT_NO_LINK) { // data of AT+CIPSEND
+    sendReceived++;
+    if (sendEx && sendBackslash && b == '0') {
+      sendReceived -= 2;
+      sendDone();
+    } else if (sendReceived == sendLength) {
+      sendDone();
+    }
+    sendBackslash = (b == '\\');
+  } else if (b == '\n') {
+    line[lineLength] = 0;
+    if (lineLength) {
+      command();
+    }
+    lineLength = 0;
+  } else if (b != '\r' && lineLength < sizeof(line) - 1) {
+    line[lineLength++] = b;
+  }
+  return 1;
+}
+
+const char* WiFiEspAtSimulator::param(const char* prefix) {
+  size_t l = strlen(prefix);
+  return strncmp(line, prefix, l) ? nullptr : line + l;
+}
+
+void WiFiEspAtSimulator::command() {
+  for (uint8_t i = 0; i < scriptLength; i++) {
+    if (param(script[i].command)) {
+      reply(script[i].response);
+      return;
+    }
+  }
+  const char* p;
+  if ((p = param("AT+CIPSTART="))) {
+    uint8_t linkId = atoi(p);
+    const char* type = strchr(p, '"');
+    const char* host = type ? strchr(type + 1, ',') : nullptr;
+    const char* port = host ? strchr(host + 1, ',') : nullptr;
+    if (linkId >= WIFIESPAT_LINKS_COUNT || !port) {
+      reply("\r\nERROR\r\n");
+    } else if (links[linkId].open) {
+      reply("ALREADY CONNECTED\r\n\r\nERROR\r\n");
+    } else {
+      const char* localPort = strchr(port + 1, ',');
+      links[linkId].open = true;
+      links[linkId].udp = !strncmp(type, "\"UDP\"", 5);
+      links[linkId].incoming = false;
+      links[linkId].remotePort = atoi(port + 1);
+      links[linkId].localPort = (links[linkId].udp && localPort) ? atoi(localPort + 1) : 0;
+      links[linkId].available = 0;
+      reply((long) linkId);
+      reply(",CONNECT\r\n\r\nOK\r\n");
+    }
+  } else if ((p = param("AT+CIPSEND=")) || (p = param("AT+CIPSENDEX="))) {
+    uint8_t linkId = atoi(p);
+    const char* length = strchr(p, ',');
+    if (linkId >= WIFIESPAT_LINKS_COUNT || !links[linkId].open || !length) {
+      reply("link is not valid\r\n\r\nERROR\r\n");
+    } else {
+      sendLinkId = linkId;
+      sendLength = atol(length + 1);
+      sendReceived = 0;
+      sendEx = (line[strlen("AT+CIPSEND")] == 'E');
+      sendBackslash = false;
+#ifdef WIFIESPAT1
+      reply("\r\nOK\r\n> ");
+#else
+      reply("\r\nOK\r\n\r\n>");
+#endif
+    }
+  } else if ((p = param("AT+CIPRECVDATA="))) {
+    uint8_t linkId = atoi(p);
+    const char* size = strchr(p, ',');
+    if (linkId >= WIFIESPAT_LINKS_COUNT || !links[linkId].available || !size) {
+      reply("\r\nERROR\r\n");
+    } else {
+      size_t length = atol(size + 1);
+      if (length > links[linkId].available) {
+        length = links[linkId].available;
+      }
+      size_t room = WIFIESPAT_SIM_BUFFER_SIZE - outLength;
+      room = (room > 40) ? room - 40 : 0; // 40 for the text
+      if (length > room) {
+        length = room;
+      }
+      length = takeData(linkId, length);
+#ifdef WIFIESPAT1
+      reply("+CIPRECVDATA,");
+      reply((long) length);
+      reply((uint8_t) ':');
+#else
+      reply("+CIPRECVDATA:");
+      reply((long) length);
+      reply((uint8_t) ',');
+      if (dataInfo) {
+        reply(REMOTE_IP);
+        reply((uint8_t) ',');
+        reply((long) links[linkId].remotePort);
+        reply((uint8_t) ',');
+      }
+#endif
+      replyData(length);
+      reply("\r\nOK\r\n");
+    }
+  } else if (param("AT+CIPRECVLEN?")) {
+    reply("+CIPRECVLEN:");
+    for (uint8_t i = 0; i < WIFIESPAT_LINKS_COUNT; i++) {
+      if (i) {
+        reply((uint8_t) ',');
+      }
+#ifdef WIFIESPAT1
+      reply((long) links[i].available);
+#else
+      reply(links[i].open ? (long) links[i].available : -1L);
+#endif
+    }
+    reply("\r\n\r\nOK\r\n");
+  } else if (param("AT+CIPSTATUS")) {
+    bool connected = false;
+    for (uint8_t i = 0; i < WIFIESPAT_LINKS_COUNT; i++) {
+      connected |= links[i].open;
+    }
+    reply(connected ? "STATUS:3\r\n" : "STATUS:2\r\n");
+    for (uint8_t i = 0; i < WIFIESPAT_LINKS_COUNT; i++) {
+      if (!links[i].open)
+        continue;
+      reply("+CIPSTATUS:");
+      reply((long) i);
+      reply(links[i].udp ? ",\"UDP\"," : ",\"TCP\",");
+      reply(REMOTE_IP);
+      reply((uint8_t) ',');
+      reply((long) links[i].remotePort);
+      reply((uint8_t) ',');
+      reply((long) links[i].localPort);
+      reply(links[i].incoming ? ",1\r\n" : ",0\r\n");
+    }
+    reply("\r\nOK\r\n");
+  } else if ((p = param("AT+CIPCLOSE="))) {
+    uint8_t linkId = atoi(p);
+    if (linkId >= WIFIESPAT_LINKS_COUNT || !links[linkId].open) {
+      reply("UNLINK\r\n\r\nERROR\r\n");
+    } else {
+      links[linkId].open = false;
+      links[linkId].available = 0;
+      dropUdpPackets(linkId);
+      reply((long) linkId);
+      reply(",CLOSED\r\n\r\nOK\r\n");
+    }
+  } else if ((p = param("AT+CIPSERVERMAXCONN="))) {
+    reply(serverPort ? "\r\nERROR\r\n" : "\r\nOK\r\n"); // the firmware rejects it while a server runs
+  } else if ((p = param("AT+CIPSERVER="))) {
+    if (*p == '0') {
+      serverPort = 0;
+      reply("\r\nOK\r\n");
+    } else if (serverPort) {
+      reply("\r\nERROR\r\n");
+    } else {
+      const char* port = strchr(p, ',');
+      serverPort = port ? atoi(port + 1) : 333;
+      reply("\r\nOK\r\n");
+    }
+#ifndef WIFIESPAT1
+  } else if (param("AT+CIPSERVER?")) {
+    if (serverPort) {
+      reply("+CIPSERVER:1,");
+      reply((long) serverPort);
+      reply(",\"TCP\"\r\n\r\nOK\r\n");
+    } else {
+      reply("+CIPSERVER:0\r\n\r\nOK\r\n");
+    }
+#endif
+  } else if ((p = param("AT+CIPDINFO="))) {
+    dataInfo = (*p == '1');
+    reply("\r\nOK\r\n");
+#ifndef WIFIESPAT1
+  } else if ((p = param("AT+SYSMSG="))) {
+    linkConnInfo = (atoi(p) & 2);
+    reply("\r\nOK\r\n");
+#endif
+  } else if (param("AT+RST")) {
+    for (uint8_t i = 0; i < WIFIESPAT_LINKS_COUNT; i++) {
+      links[i].open = false;
+      links[i].available = 0;
+      dropUdpPackets(i);
+    }
+    serverPort = 0;
+    dataInfo = false;
+    linkConnInfo = false;
+    reply("\r\nOK\r\n\r\nready\r\n");
+  } else if (param("AT+CWMODE?")) {
+    reply("+CWMODE:1\r\n\r\nOK\r\n");
+  } else if (param("AT+CIPMUX?")) {
+    reply("+CIPMUX:1\r\n\r\nOK\r\n");
+  } else if (param("AT+CIPRECVMODE?")) {
+    reply("+CIPRECVMODE:1\r\n\r\nOK\r\n");
+  } else if (param("AT+CIPSTA?")) {
+    reply("+CIPSTA:ip:\"192.168.1.20\"\r\n+CIPSTA:gateway:\"192.168.1.1\"\r\n"
+        "+CIPSTA:netmask:\"255.255.255.0\"\r\n\r\nOK\r\n");
+  } else if (param("AT")) {
+    reply("\r\nOK\r\n");
+  } else {
+    reply("\r\nERROR\r\n");
+  }
+}
+
+void WiFiEspAtSimulator::sendDone() {
+  uint8_t linkId = sendLinkId;
+  sendLinkId = WIFIESPAT_NO_LINK;
+  receivedCount += sendReceived;
+  reply("\r\nRecv ");
+  reply((long) sendReceived);
+  reply(" bytes\r\n\r\nSEND OK\r\n");
+  if (echo) {
+    remoteSend(linkId, sendReceived);
+  }
+}
+
+/**
+ * AT2 returns one datagram for AT+CIPRECVDATA of a UDP link.
+ * the rest of a datagram larger than the requested length is discarded
+ */
+size_t WiFiEspAtSimulator::takeData(uint8_t linkId, size_t length) {
+#ifndef WIFIESPAT1
+  for (uint8_t i = 0; links[linkId].udp && i < udpPacketsCount; i++) {
+    if (udpPackets[i].linkId != linkId)
+      continue;
+    size_t packetLength = udpPackets[i].length;
+    links[linkId].available -= packetLength;
+    udpPacketsCount--;
+    memmove(&udpPackets[i], &udpPackets[i + 1], (udpPacketsCount - i) * sizeof(udpPackets[0]));
+    return (length < packetLength) ? length : packetLength;
+  }
+#endif
+  links[linkId].available -= length;
+  return length;
+}
+
+void WiFiEspAtSimulator::dropUdpPackets(uint8_t linkId) {
+#ifdef WIFIESPAT1
+  (void) linkId;
+#else
+  uint8_t count = 0;
+  for (uint8_t i = 0; i < udpPacketsCount; i++) {
+    if (udpPackets[i].linkId != linkId) {
+      udpPackets[count++] = udpPackets[i];
+    }
+  }
+  udpPacketsCount = count;
+#endif
+}
+
+void WiFiEspAtSimulator::reply(const char* s) {
+  while (*s) {
+    reply((uint8_t) *s++);
+  }
+}
+
+void WiFiEspAtSimulator::reply(long n) {
+  char s[12];
+  uint8_t i = sizeof(s) - 1;
+  s[i] = 0;
+  bool negative = (n < 0);
+  unsigned long u = negative ? -n : n;
+  do {
+    s[--i] = '0' + (u % 10);
+    u /= 10;
+  } while (u);
+  if (negative) {
+    s[--i] = '-';
+  }
+  reply(s + i);
+}
+
+void WiFiEspAtSimulator::reply(uint8_t b) {
+  if (outLength == WIFIESPAT_SIM_BUFFER_SIZE)
+    return; // overflow, as with a full serial RX buffer
+  if (!outLength) {
+    paceStart = micros() + latency;
+    paced = 0;
+  }
+  out[(outIndex + outLength) % WIFIESPAT_SIM_BUFFER_SIZE] = b;
+  outLength++;
+}
+
+void WiFiEspAtSimulator::replyData(size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    reply((uint8_t) ('a' + pattern));
+    pattern = (pattern + 1) % 26;
+  }
+}
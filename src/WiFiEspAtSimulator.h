@@ -0,0 +1,117 @@
+/*
+  This file is part of the WiFiEspAT library for Arduino
+  https://github.com/jandrassy/WiFiEspAT
+  Copyright 2024 Juraj Andrassy
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _WIFIESPAT_SIMULATOR_H_
+#define _WIFIESPAT_SIMULATOR_H_
+
+#include <Arduino.h>
+#include "utility/EspAtDrvTypes.h"
+
+#ifndef WIFIESPAT_SIM_BUFFER_SIZE
+#define WIFIESPAT_SIM_BUFFER_SIZE 2200 // output of the simulated firmware. for AT+CIPRECVDATA of 2048 bytes
+#endif
+
+const uint8_t SIM_SCRIPT_SIZE = 8;
+const uint8_t SIM_UDP_PACKETS = 24; // AT2 datagrams waiting for AT+CIPRECVDATA
+
+/**
+ * Simulated AT firmware to use in WiFi.init instead of the Serial of the ESP module.
+ * It answers the commands used by the library for the AT version the library is built for
+ * (AT+CIPSTART, AT+CIPSEND, AT+CIPRECVDATA, AT+CIPRECVLEN?, AT+CIPSTATUS, AT+CIPCLOSE, ...)
+ * and other commands with OK. Responses for other commands can be set with setResponse.
+ * The remote side of the connections is driven with the remote* functions.
+ * Received data are generated. Sent data are counted.
+ */
+class WiFiEspAtSimulator : public Stream {
+public:
+  WiFiEspAtSimulator(unsigned long baudRate = 115200) {setBaudRate(baudRate);}
+
+  void setBaudRate(unsigned long baudRate) {byteTime = baudRate ? 10000000UL / baudRate : 0;} // 0 is no pacing
+  void setLatency(unsigned long micros) {latency = micros;} // before the module starts to respond
+  bool setResponse(const char* command, const char* response); // for commands starting with `command`
+  void setEcho(bool on) {echo = on;} // data sent to a link are sent back by the remote side
+
+  bool remoteConnect(uint8_t linkId, uint16_t localPort, uint16_t remotePort = 50000);
+  bool remoteSend(uint8_t linkId, size_t length);
+  bool remoteClose(uint8_t linkId);
+  unsigned long remoteReceived() {return receivedCount;} // bytes sent to all links
+
+  virtual int available();
+  virtual int read();
+  virtual int peek();
+  virtual size_t write(uint8_t b);
+
+private:
+  struct {
+    bool open;
+    bool udp;
+    bool incoming;
+    uint16_t remotePort;
+    uint16_t localPort;
+    size_t available;
+  } links[WIFIESPAT_LINKS_COUNT] = {};
+  struct {
+    const char* command;
+    const char* response;
+  } script[SIM_SCRIPT_SIZE];
+  uint8_t scriptLength = 0;
+#ifndef WIFIESPAT1
+  struct {
+    uint8_t linkId;
+    uint16_t length;
+  } udpPackets[SIM_UDP_PACKETS]; // oldest first
+  uint8_t udpPacketsCount = 0;
+#endif
+
+  char line[128]; // the received command
+  uint8_t lineLength = 0;
+  uint8_t sendLinkId = WIFIESPAT_NO_LINK; // data of AT+CIPSEND are received
+  size_t sendLength;
+  size_t sendReceived;
+  bool sendEx; // AT+CIPSENDEX data end with \0
+  bool sendBackslash;
+
+  uint8_t out[WIFIESPAT_SIM_BUFFER_SIZE]; // ring buffer
+  size_t outIndex = 0;
+  size_t outLength = 0;
+  unsigned long paceStart; // micros when the first byte in out can be read
+  size_t paced = 0; // bytes read since paceStart
+
+  unsigned long byteTime; // micros to transfer one byte
+  unsigned long latency = 0;
+  unsigned long lastWrite = 0;
+  bool echo = false;
+  uint16_t serverPort = 0; // of AT+CIPSERVER=1
+  bool dataInfo = false;
+  bool linkConnInfo = false;
+  uint8_t pattern = 0;
+  unsigned long receivedCount = 0;
+
+  void command();
+  const char* param(const char* prefix);
+  void sendDone();
+  size_t takeData(uint8_t linkId, size_t length); // for AT+CIPRECVDATA
+  void dropUdpPackets(uint8_t linkId);
+  void reply(const char* s);
+  void reply(long n);
+  void reply(uint8_t b);
+  void replyData(size_t length);
+};
+
+#endif
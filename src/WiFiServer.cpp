@@ -19,6 +19,7 @@
 
 #include "utility/EspAtDrv.h"
 #include "WiFiServer.h"
+#include "WiFiEspAtBuffManager.h"
 
 WiFiServer::WiFiServer(uint16_t _port) {
   port = _port;
@@ -28,6 +29,9 @@ WiFiServer::WiFiServer(uint16_t _port) {
 void WiFiServer::begin(uint8_t maxConnCount, uint16_t serverTimeout) {
 	end();
   state = EspAtDrv.serverBegin(port, maxConnCount, serverTimeout) ? LISTEN : CLOSED;
+  if (state == LISTEN && eventCallback != nullptr) {
+    EspAtDrv.setServerEventCallback(port, eventCallback);
+  }
 }
 
 void WiFiServer::begin(uint16_t _port, uint8_t maxConnCount, uint16_t serverTimeout) {
@@ -39,6 +43,9 @@ void WiFiServer::begin(uint16_t _port, uint8_t maxConnCount, uint16_t serverTime
 void WiFiServer::beginSSL(bool ca, uint8_t maxConnCount, uint16_t serverTimeout) {
 	end();
   state = EspAtDrv.serverBegin(port, maxConnCount, serverTimeout, true, ca) ? LISTEN : CLOSED;
+  if (state == LISTEN && eventCallback != nullptr) {
+    EspAtDrv.setServerEventCallback(port, eventCallback);
+  }
 }
 
 void WiFiServer::beginSSL(uint16_t _port, bool ca, uint8_t maxConnCount, uint16_t serverTimeout) {
@@ -52,6 +59,7 @@ void WiFiServer::end() {
     if (EspAtDrv.serverEnd(port)) {
       state = CLOSED;
     }
+    EspAtDrv.setServerEventCallback(port, nullptr);
   }
 }
 
@@ -65,6 +73,7 @@ WiFiClient WiFiServer::available() {
 
 WiFiClient WiFiServer::accept() {
   if (state != CLOSED) {
+    closeIdleLink();
     uint8_t linkId = EspAtDrv.newClientLinkId(port);
     if (linkId != NO_LINK)
       return WiFiClient(linkId);
@@ -72,6 +81,54 @@ WiFiClient WiFiServer::accept() {
   return WiFiClient();
 }
 
+EspAtLinksState WiFiServer::poll() {
+  if (state != CLOSED) {
+    closeIdleLink();
+  }
+  EspAtLinksState links;
+  EspAtDrv.pollLinks(links, port);
+  if (state == CLOSED) {
+    links.incoming = 0;
+  }
+  return links;
+}
+
+void WiFiServer::onEvent(EspAtLinkEventCallback callback) {
+  eventCallback = callback;
+  if (state != CLOSED) {
+    EspAtDrv.setServerEventCallback(port, callback);
+  }
+}
+
+uint8_t WiFiServer::broadcast(const uint8_t* data, size_t length) {
+  if (state == CLOSED || length == 0)
+    return 0;
+  uint8_t linkIds[LINKS_COUNT];
+  uint8_t count = EspAtDrv.serverLinkIds(port, linkIds);
+  uint8_t sent = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    WiFiEspAtBuffManager.flush(linkIds[i]); // send the client's buffered data first
+    if (EspAtDrv.sendData(linkIds[i], data, length, nullptr, 0) == length) {
+      sent |= (1 << (linkIds[i] & INDEX_MASK));
+    }
+  }
+  return sent;
+}
+
+void WiFiServer::setIdleLinkPolicy(WiFiIdleLinkPolicy policy, unsigned long _idleTime) {
+  idleLinkPolicy = policy;
+  idleTime = _idleTime;
+}
+
+void WiFiServer::closeIdleLink() {
+  if (idleLinkPolicy == IDLE_LINK_KEEP)
+    return;
+  uint8_t linkId = EspAtDrv.idleLinkId(port, idleTime, idleLinkPolicy == IDLE_LINK_CLOSE_LRU);
+  if (linkId != NO_LINK) {
+    EspAtDrv.close(linkId);
+  }
+}
+
 WiFiServer::operator bool() {
   return (state != CLOSED);
 }
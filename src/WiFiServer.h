@@ -30,6 +30,12 @@
 #define WIFIESPAT_SERVER_CLIENT_TIMEOUT 60  // seconds
 #endif
 
+enum WiFiIdleLinkPolicy {
+  IDLE_LINK_KEEP,       // connections are closed only by AT firmware's serverTimeout
+  IDLE_LINK_CLOSE_LRU,  // if all links are used, close the least recently active link idle for idleTime (> 0)
+  IDLE_LINK_CLOSE_IDLE  // close every link idle for idleTime (> 0)
+};
+
 class WiFiServer {
 
 public:
@@ -46,11 +52,22 @@ public:
   uint8_t status();
   WiFiClient available() __attribute__((deprecated("Use accept().")));
   WiFiClient accept();
+  EspAtLinksState poll(); // state of all links with one query. see WiFiClient.isReadable()
+  void onEvent(EspAtLinkEventCallback callback); // fired from WiFi.maintain() for the server's links
+  // sends the data to all accepted clients without copying them. returns the bit mask of links sent to
+  uint8_t broadcast(const uint8_t* data, size_t length);
+  uint8_t broadcast(const char* s) { return broadcast((const uint8_t*) s, strlen(s)); }
+  void setIdleLinkPolicy(WiFiIdleLinkPolicy policy, unsigned long idleTime = 0); // applied in accept() and poll(). idleTime 0 closes nothing
   virtual operator bool();
 
 private:
   uint16_t port;
   uint8_t state;
+  EspAtLinkEventCallback eventCallback = nullptr;
+  WiFiIdleLinkPolicy idleLinkPolicy = IDLE_LINK_KEEP;
+  unsigned long idleTime = 0;
+
+  void closeIdleLink();
 };
 
 #endif
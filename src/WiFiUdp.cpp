@@ -30,21 +30,12 @@ int WiFiUDP::beginPacket(const char *host, uint16_t port) {
   if (txStream) {
     endPacket();
   }
-  uint8_t linkId;
-  if (listening) {
-    linkId = this->linkId; // AT allows to use the listener's linkId for sending
-  } else {
-    linkId = EspAtDrv.connect("UDP", host, port);
-  }
+  uint8_t linkId = sendLinkId(host, port);
   if (linkId == NO_LINK)
     return false;
   txStream = WiFiEspAtBuffManager.getBuffStream(linkId, 0, WIFIESPAT_UDP_TX_BUFFER_SIZE);
-  if (!txStream) {
-   if (!listening) {
-    EspAtDrv.close(linkId);
-   }
+  if (!txStream)
     return false;
-  }
   txStream->setUdpPort(host, port);
   return true;
 }
@@ -53,15 +44,43 @@ int WiFiUDP::endPacket() {
   if (!txStream)
     return 0;
   flush();
-  if (listening) {
-    txStream->free();
-  } else {
-    txStream->close();
-  }
+  txStream->free(); // the link stays open
   txStream = nullptr;
   return !getWriteError();
 }
 
+uint8_t WiFiUDP::sendBatch(const WiFiEspAtUdpMsg msgs[], uint8_t count, bool sent[]) {
+  if (txStream) {
+    endPacket();
+  }
+  uint8_t linkId = count ? sendLinkId(msgs[0].host, msgs[0].port) : NO_LINK;
+  uint8_t sentCount = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    const WiFiEspAtUdpMsg& msg = msgs[i];
+    bool ok = (linkId != NO_LINK && msg.length > 0
+        && EspAtDrv.sendData(linkId, msg.data, msg.length, msg.host, msg.port) == msg.length);
+    if (ok) {
+      sentCount++;
+    }
+    if (sent) {
+      sent[i] = ok;
+    }
+  }
+  return sentCount;
+}
+
+uint8_t WiFiUDP::sendLinkId(const char* host, uint16_t port) {
+  if (listening)
+    return linkId; // AT allows to use the listener's linkId for sending
+  if (senderLinkId == NO_LINK || !EspAtDrv.connected(senderLinkId)) {
+    senderLinkId = EspAtDrv.connect("UDP", host, port);
+    if (senderLinkId != NO_LINK) {
+      EspAtDrv.setCloseOnIdle(senderLinkId);
+    }
+  }
+  return senderLinkId; // the message is sent with the host and port so the link can be reused
+}
+
 size_t WiFiUDP::write(uint8_t b) {
   if (!txStream)
     return 0;
@@ -103,6 +122,8 @@ uint8_t WiFiUDP::begin(uint16_t port) {
 }
 
 IPAddress WiFiUDP::remoteIP() {
+  if (senderPort != 0) // from +IPD with AT+CIPDINFO=1
+    return senderIP;
   IPAddress ip;
   uint16_t port = 0;
   uint16_t lport = 0;
@@ -113,6 +134,8 @@ IPAddress WiFiUDP::remoteIP() {
 }
 
 uint16_t WiFiUDP::remotePort() {
+  if (senderPort != 0) // from +IPD with AT+CIPDINFO=1
+    return senderPort;
   IPAddress ip;
   uint16_t port = 0;
   uint16_t lport = 0;
@@ -160,14 +183,34 @@ size_t WiFiUDP::parsePacket(uint8_t* buffer, size_t size, IPAddress& remoteIP, u
 }
 #endif
 
+WiFiUDP::~WiFiUDP() {
+  if (senderLinkId != NO_LINK) {
+    EspAtDrv.close(senderLinkId);
+  }
+}
+
 void WiFiUDP::stop() {
   if (rxStream) {
     rxStream->free();
     rxStream = nullptr;
   }
+#ifdef WIFIESPAT1
+  if (rxQueue) {
+    rxQueue->free();
+    rxQueue = nullptr;
+  }
+  rxQueueCount = 0;
+  rxUserLength = 0;
+  rxUserParsed = false;
+  senderPort = 0;
+#endif
   if (txStream) {
     endPacket();
   }
+  if (senderLinkId != NO_LINK) {
+    EspAtDrv.close(senderLinkId);
+    senderLinkId = NO_LINK;
+  }
   if (linkId == NO_LINK)
     return;
   EspAtDrv.close(linkId);
@@ -179,11 +222,25 @@ int WiFiUDP::parsePacket() {
   if (linkId == NO_LINK)
     return 0;
 #ifdef WIFIESPAT1
+  if (rxUserBuffer) {
+    if (rxUserParsed) { // the sketch is done with the previous packet
+      rxUserLength = 0;
+    }
+    EspAtDrv.maintain();
+    if (rxQueueCount && !rxUserLength) {
+      dequeueRxData();
+    }
+    rxUserParsed = (rxUserLength > 0);
+    return rxUserLength;
+  }
   if (rxStream && rxStream->rxBufferIndex > 0) { // clear already read packet
     rxStream->free();
     rxStream = nullptr;
   }
   EspAtDrv.maintain();
+  if (rxQueueCount && !available()) {
+    dequeueRxData();
+  }
 #else
   if (rxStream) {
     rxStream->free();
@@ -224,11 +281,38 @@ int WiFiUDP::peek() {
 }
 
 #ifdef WIFIESPAT1
-uint8_t WiFiUDP::readRxData(Stream* serial, size_t len) {
-  if (available() > 0) // to avoid overwrite of previous packet
-    return BUSY;
+void WiFiUDP::setReceiveBuffer(uint8_t* buffer, size_t size) {
+  if (rxStream) {
+    rxStream->free();
+    rxStream = nullptr;
+  }
+  rxUserBuffer = buffer;
+  rxUserBufferSize = buffer ? size : 0;
+  rxUserLength = 0;
+  rxUserParsed = false;
+}
+
+uint8_t WiFiUDP::readRxData(Stream* serial, size_t len, const IPAddress& remoteIP, uint16_t remotePort) {
+  if (rxUserBuffer) { // read directly into the sketch's buffer
+    if (len > rxUserBufferSize)
+      return LARGE;
+    if (rxUserLength > 0 || rxQueueCount > 0) // to avoid overwrite of previous packet
+      return queueRxData(serial, len, remoteIP, remotePort);
+    if (serial->readBytes(rxUserBuffer, len) != len)
+      return TIMEOUT;
+    rxUserLength = len;
+    senderIP = remoteIP;
+    senderPort = remotePort;
+    return OK;
+  }
   if (len > WIFIESPAT_UDP_RX_BUFFER_SIZE)
     return LARGE;
+  if (available() > 0 || rxQueueCount > 0) // to avoid overwrite of previous packet
+    return queueRxData(serial, len, remoteIP, remotePort);
+  if (rxStream) { // return the buffer of the read packet to the pool
+    rxStream->free();
+    rxStream = nullptr;
+  }
   rxStream = WiFiEspAtBuffManager.getBuffStream(NO_LINK, WIFIESPAT_UDP_RX_BUFFER_SIZE, 0);
   if (!rxStream)
     return BUSY;
@@ -239,6 +323,94 @@ uint8_t WiFiUDP::readRxData(Stream* serial, size_t len) {
     return TIMEOUT;
   }
   rxStream->rxBufferLength = len;
+  senderIP = remoteIP;
+  senderPort = remotePort;
   return OK;
 }
+
+uint8_t WiFiUDP::queueRxData(Stream* serial, size_t len, const IPAddress& remoteIP, uint16_t remotePort) {
+  const size_t size = WIFIESPAT_UDP_RX_QUEUE_SIZE;
+  if (size > 0 && !rxQueue) {
+    rxQueue = WiFiEspAtBuffManager.getBuffStream(NO_LINK, size, 0);
+    rxQueueHead = 0;
+    rxQueueLength = 0;
+  }
+  if (!rxQueue || size - rxQueueLength < len + RX_QUEUE_HEADER_SIZE) {
+    rxDropCount++;
+    uint8_t b;
+    for (size_t i = 0; i < len; i++) { // skip the message
+      serial->readBytes(&b, 1);
+    }
+    return BUSY;
+  }
+  IPAddress ip = remoteIP;
+  uint8_t header[RX_QUEUE_HEADER_SIZE] = {(uint8_t) (len & 0xFF), (uint8_t) (len >> 8), ip[0], ip[1], ip[2], ip[3],
+      (uint8_t) (remotePort & 0xFF), (uint8_t) (remotePort >> 8)};
+  uint8_t* ring = rxQueue->rxBuffer;
+  size_t tail = rxQueueHead + rxQueueLength;
+  if (tail >= size) {
+    tail -= size;
+  }
+  for (uint8_t i = 0; i < RX_QUEUE_HEADER_SIZE; i++) { // no % size. size is 0 if the queue is disabled
+    ring[tail++] = header[i];
+    if (tail == size) {
+      tail = 0;
+    }
+  }
+  size_t l = size - tail; // space to end of ring
+  if (l > len) {
+    l = len;
+  }
+  size_t r = serial->readBytes(ring + tail, l);
+  if (r == l && l < len) { // wrap
+    r += serial->readBytes(ring, len - l);
+  }
+  if (r != len) // timeout. the message is not added
+    return TIMEOUT;
+  rxQueueLength += len + RX_QUEUE_HEADER_SIZE;
+  rxQueueCount++;
+  return OK;
+}
+
+void WiFiUDP::dequeueRxData() {
+  if (rxUserBuffer) {
+    rxUserLength = dequeueRxData(rxUserBuffer);
+    return;
+  }
+  if (rxStream) {
+    rxStream->free();
+  }
+  rxStream = WiFiEspAtBuffManager.getBuffStream(NO_LINK, WIFIESPAT_UDP_RX_BUFFER_SIZE, 0);
+  if (!rxStream)
+    return;
+  rxStream->rxBufferLength = dequeueRxData(rxStream->rxBuffer);
+}
+
+size_t WiFiUDP::dequeueRxData(uint8_t* data) {
+  const size_t size = WIFIESPAT_UDP_RX_QUEUE_SIZE;
+  uint8_t* ring = rxQueue->rxBuffer;
+  uint8_t header[RX_QUEUE_HEADER_SIZE];
+  for (uint8_t i = 0; i < RX_QUEUE_HEADER_SIZE; i++) {
+    header[i] = ring[rxQueueHead++];
+    if (rxQueueHead == size) {
+      rxQueueHead = 0;
+    }
+  }
+  size_t len = header[0] | (header[1] << 8);
+  senderIP = IPAddress(header[2], header[3], header[4], header[5]);
+  senderPort = header[6] | (header[7] << 8);
+  for (size_t i = 0; i < len; i++) {
+    data[i] = ring[rxQueueHead++];
+    if (rxQueueHead == size) {
+      rxQueueHead = 0;
+    }
+  }
+  rxQueueLength -= len + RX_QUEUE_HEADER_SIZE;
+  rxQueueCount--;
+  if (rxQueueCount == 0) { // return the queue's buffer to the pool
+    rxQueue->free();
+    rxQueue = nullptr;
+  }
+  return len;
+}
 #endif
@@ -25,6 +25,13 @@
 #include "WiFiEspAtSharedBuffStreamPtr.h"
 #include "utility/EspAtDrvTypes.h"
 
+struct WiFiEspAtUdpMsg {
+  const char* host; // IP address or host name
+  uint16_t port;
+  const uint8_t* data;
+  size_t length;
+};
+
 class WiFiUDP : public UDP
 #ifdef WIFIESPAT1
 , protected EspAtDrvUdpDataCallback
@@ -32,6 +39,8 @@ class WiFiUDP : public UDP
 {
 public:
 
+  virtual ~WiFiUDP(); // closes the sender link
+
   // Sending UDP packets
   virtual int beginPacket(IPAddress ip, uint16_t port);
   virtual int beginPacket(const char *host, uint16_t port);
@@ -46,6 +55,9 @@ public:
 
   using Print::write;
 
+  // sends the messages with one AT+CIPSEND each on the same link. returns the count of sent messages
+  uint8_t sendBatch(const WiFiEspAtUdpMsg msgs[], uint8_t count, bool sent[] = nullptr);
+
   virtual uint8_t begin(uint16_t port);
 
 #ifndef WIFIESPAT1 // AT2
@@ -70,8 +82,14 @@ public:
   virtual IPAddress remoteIP();
   virtual uint16_t remotePort();
 
+  uint8_t queuedPackets() {return rxQueueCount;} // received messages waiting for parsePacket()
+  uint16_t droppedPackets() {return rxDropCount;} // messages dropped because the queue was full
+
+  // received messages are read into this buffer. parsePacket() returns the size of the message in it
+  void setReceiveBuffer(uint8_t* buffer, size_t size);
+
 protected:
-  virtual uint8_t readRxData(Stream* serial, size_t len); // EspAtDrvUdpDataCallback implementation
+  virtual uint8_t readRxData(Stream* serial, size_t len, const IPAddress& remoteIP, uint16_t remotePort); // EspAtDrvUdpDataCallback implementation
 
 #else
   virtual IPAddress remoteIP() {return senderIP;}
@@ -81,15 +99,32 @@ protected:
 
 private:
   uint8_t linkId = WIFIESPAT_NO_LINK;
+  uint8_t senderLinkId = WIFIESPAT_NO_LINK; // kept open for the next beginPacket() if not listening
   bool listening = false;
   WiFiEspAtSharedBuffStreamPtr txStream;
   WiFiEspAtSharedBuffStreamPtr rxStream;
   char strIP[16]; // to hold the string version of IP for beginPacket(ip, port);
-
-#ifndef WIFIESPAT1 //AT2
   IPAddress senderIP;
-  uint16_t senderPort;
+  uint16_t senderPort = 0;
 
+  uint8_t sendLinkId(const char* host, uint16_t port);
+
+#ifdef WIFIESPAT1
+  static const uint8_t RX_QUEUE_HEADER_SIZE = 8; // length, IP, port
+  WiFiEspAtSharedBuffStreamPtr rxQueue; // ring of messages as [length (2 bytes), IP (4 bytes), port (2 bytes), data]
+  size_t rxQueueHead = 0;
+  size_t rxQueueLength = 0;
+  uint8_t rxQueueCount = 0;
+  uint16_t rxDropCount = 0;
+  uint8_t* rxUserBuffer = nullptr; // set with setReceiveBuffer()
+  size_t rxUserBufferSize = 0;
+  size_t rxUserLength = 0;
+  bool rxUserParsed = false; // returned by parsePacket(). will be released with next parsePacket()
+
+  uint8_t queueRxData(Stream* serial, size_t len, const IPAddress& remoteIP, uint16_t remotePort);
+  void dequeueRxData();
+  size_t dequeueRxData(uint8_t* data);
+#else //AT2
   uint8_t begin(const char* ip, uint16_t port);
 #endif
 };
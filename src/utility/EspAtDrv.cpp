@@ -28,7 +28,56 @@
 
 //#define ESPATDRV_ASSUME_FLOW_CONTROL
 
+#if WIFIESPAT_TRAFFIC_STATS
+#define COUNT_LINK_TRAFFIC(linkId, counter, n) (linkInfo[linkId].stats.counter += (n), trafficStats.total.counter += (n))
+#define COUNT_TRAFFIC(counter) trafficStats.counter++
+#else
+#define COUNT_LINK_TRAFFIC(linkId, counter, n)
+#define COUNT_TRAFFIC(counter)
+#endif
+
+#if WIFIESPAT_TRACE_SIZE
+#define TRACE(event, linkId, arg) trace(EspAtTraceEvent::event, (linkId), (arg))
+
+#if defined(__AVR__) || defined(__arm__)
+#define TRACE_NOINIT __attribute__((section(".noinit"))) // not cleared by a watchdog or brown-out reset
+#else
+#define TRACE_NOINIT
+#endif
+
+const uint32_t TRACE_MAGIC = 0x54524345;
+
+/*
+ * outside of EspAtDrvClass, so it is not zeroed by its constructor.
+ * the magic word tells if the content survived a reset of the MCU
+ */
+struct TraceRing {
+  uint32_t magic;
+  uint16_t head; // next record is written here
+  bool wrapped;
+  EspAtTraceRecord records[WIFIESPAT_TRACE_SIZE];
+};
+static TraceRing traceRing TRACE_NOINIT;
+static bool traceChecked = false;
+
+static TraceRing& checkedTraceRing() {
+  if (!traceChecked) {
+    if (traceRing.magic != TRACE_MAGIC || traceRing.head >= WIFIESPAT_TRACE_SIZE) { // power-on
+      traceRing.magic = TRACE_MAGIC;
+      traceRing.head = 0;
+      traceRing.wrapped = false;
+    }
+    traceChecked = true;
+  }
+  return traceRing;
+}
+#else
+#define TRACE(event, linkId, arg)
+#endif
+
 const uint8_t TIMEOUT_COUNT = 3;
+const unsigned long AP_SCAN_TIMEOUT = 20000; // millis
+const uint8_t FAST_JOIN_TIMEOUT = 5; // seconds
 
 const uint8_t WIFI_MODE_STA = 0b01;
 const uint8_t WIFI_MODE_SAP = 0b10;
@@ -45,6 +94,34 @@ const char QOUT_COMMA_QOUT[] PROGMEM = "\",\"";
 const char PROCESSED[] PROGMEM = " ...processed";
 const char IGNORED[] PROGMEM = " ...ignored";
 
+static uint32_t fnv1a(uint32_t hash, const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    hash = (hash ^ data[i]) * 16777619UL;
+  }
+  return hash;
+}
+
+const uint32_t SSL_CONFIG_UNKNOWN = 2; // a command of applySslConfig failed. not a result of sslConfigHash
+
+/**
+ * hash of the settings sent by applySslConfig. odd.
+ * 0 for null config or firmware defaults
+ */
+static uint32_t sslConfigHash(const EspAtSslConfig* config) {
+  if (!config || (!config->authMode && !config->sni && !config->alpn))
+    return 0;
+  uint8_t conf[3] = {config->authMode, config->pkiNumber, config->caNumber};
+  uint32_t hash = fnv1a(2166136261UL, conf, 3);
+  if (config->sni) {
+    hash = fnv1a(hash, (const uint8_t*) config->sni, strlen(config->sni));
+  }
+  hash = fnv1a(hash, (const uint8_t*) ",", 1);
+  if (config->alpn) {
+    hash = fnv1a(hash, (const uint8_t*) config->alpn, strlen(config->alpn));
+  }
+  return hash | 1;
+}
+
 #if WIFIESPAT_LOG_LEVEL >= LOG_LEVEL_DEBUG
 class DebugPrint : public Print {
 public:
@@ -64,20 +141,79 @@ public:
 } debugPrint;
 #endif
 
-bool EspAtDrvClass::init(Stream* _serial, int8_t resetPin) {
+#if WIFIESPAT_CMD_STATS
+// upper limits of EspAtCmdStats buckets in millis. the last bucket is for longer
+const uint16_t CMD_STATS_BUCKET_LIMITS[CMD_STATS_BUCKETS_COUNT - 1] = {1, 2, 5, 10, 50, 100, 1000};
+
+class CmdStatsPrint : public Print {
+public:
+  Print* stream;
+  char name[16]; // start of the command to determine the command type
+  uint8_t length = 0;
+  bool nl = true;
+  bool running = false;
+  unsigned long start;
+  virtual size_t write(uint8_t b) {
+    if (nl) { // first character of a command
+      start = micros();
+      running = true;
+      length = 0;
+      nl = false;
+    }
+    if (b == '\n') {
+      nl = true;
+    } else if (b != '\r' && length < sizeof(name) - 1) {
+      name[length++] = b;
+    }
+    return stream->write(b);
+  }
+} cmdStatsPrint;
+
+static FSH_P cmdTypeName(EspAtCmdType type) {
+  switch (type) {
+    case EspAtCmdType::CIPSEND:
+      return F("CIPSEND");
+    case EspAtCmdType::CIPRECVDATA:
+      return F("CIPRECVDATA");
+    case EspAtCmdType::CIPRECVLEN:
+      return F("CIPRECVLEN");
+    case EspAtCmdType::CIPSTATUS:
+      return F("CIPSTATUS");
+    case EspAtCmdType::CIPSTART:
+      return F("CIPSTART");
+    case EspAtCmdType::CIPCLOSE:
+      return F("CIPCLOSE");
+    case EspAtCmdType::CWJAP:
+      return F("CWJAP");
+    case EspAtCmdType::CWLAP:
+      return F("CWLAP");
+    default:
+      return F("OTHER");
+  }
+}
+#endif
+
+bool EspAtDrvClass::init(Stream* _serial, int8_t resetPin, bool _warmStart) {
   serial = _serial;
 #if WIFIESPAT_LOG_LEVEL < LOG_LEVEL_DEBUG
   cmd = _serial;
 #else
   debugPrint.stream = serial;
   cmd = &debugPrint;
+#endif
+#if WIFIESPAT_CMD_STATS
+  cmdStatsPrint.stream = cmd;
+  cmd = &cmdStatsPrint;
 #endif
   lastErrorCode = EspAtDrvError::NO_ERROR;
+  if (_warmStart && warmStart())
+    return true;
   return reset(resetPin);
 }
 
 bool EspAtDrvClass::reset(int8_t resetPin) {
   maintain();
+  TRACE(RESET, NO_LINK, 0);
 
   LOG_INFO_PRINT_PREFIX();
   if (resetPin >= 0) {
@@ -95,10 +231,122 @@ bool EspAtDrvClass::reset(int8_t resetPin) {
     cmd->print(F("AT+RST"));
     sendCommand(PSTR("ready")); // can be missed
   }
+  warmServerPort = 0;
   if (!simpleCommand(PSTR("ATE0")) || // turn off echo. must work
       !simpleCommand(PSTR("AT+CIPMUX=1")) ||  // Enable multiple connections.
       !simpleCommand(PSTR("AT+CIPRECVMODE=1"))) // Set TCP Receive Mode - passive
     return false;
+  return configure();
+}
+
+/**
+ * for restart of the MCU without restart of the AT firmware.
+ * if multiple connections and passive receive mode are set, the WiFi connection
+ * and the connections accepted by the firmware are kept. they are accepted by
+ * the server after its begin(). client and UDP links of the previous run are closed.
+ * the server running in the firmware is taken by serverBegin() for the same port.
+ * AT1 knows its port only from an adopted connection
+ */
+bool EspAtDrvClass::warmStart() {
+  maintain();
+
+  LOG_INFO_PRINT_PREFIX();
+  LOG_INFO_PRINTLN(F("warm start"));
+
+  if (!simpleCommand(PSTR("ATE0")))
+    return false;
+  cmd->print(F("AT+CIPMUX?"));
+  if (!sendCommand(PSTR("+CIPMUX")))
+    return false;
+  bool mux = (buffer[strlen("+CIPMUX:")] == '1');
+  if (!readOK() || !mux)
+    return false;
+  cmd->print(F("AT+CIPRECVMODE?"));
+  if (!sendCommand(PSTR("+CIPRECVMODE")))
+    return false;
+  bool passive = (buffer[strlen("+CIPRECVMODE:")] == '1');
+  if (!readOK() || !passive)
+    return false;
+#ifndef WIFIESPAT1
+  simpleCommand(PSTR("AT+CIPDINFO=0")); // could be set by the previous run
+#endif
+  if (!configure())
+    return false;
+
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) { // the tables are built from the firmware's state
+    LinkInfo& link = linkInfo[linkId];
+    link.flags = 0;
+    link.available = 0;
+    link.events = 0;
+    link.eventCallback = nullptr;
+  }
+  acceptQueueLength = 0;
+  for (int i = 0; i < SERVERS_COUNT; i++) {
+    servers[i] = ServerInfo();
+  }
+  warmServerPort = 0;
+#ifndef WIFIESPAT1
+  cmd->print(F("AT+CIPSERVER?"));
+  if (sendCommand(PSTR("+CIPSERVER"))) { // +CIPSERVER:<mode>[,<port>,<"type">]
+    const char* port = strchr(buffer, ',');
+    if (buffer[strlen("+CIPSERVER:")] == '1' && port) {
+      warmServerPort = atoi(port + 1);
+    }
+    if (!readOK())
+      return false;
+  }
+#endif
+  uint8_t clientLinks = 0;
+  cmd->print((FSH_P) AT_CIPSTATUS);
+  if (!sendCommand(STATUS))
+    return false;
+  while (readRX(CIPSTATUS, true, true)) {
+    uint8_t linkId = buffer[strlen("+CIPSTATUS:")] - 48;
+    const char* delim = ",\"";
+    char* tok = strtok(buffer, delim); // +CIPSTATUS:<link  ID>
+    char* type = strtok(NULL, delim); // <type>
+    tok = strtok(NULL, delim); // <remote IP>
+    tok = strtok(NULL, delim); // <remote port>
+    tok = strtok(NULL, delim); // <local port>
+    uint16_t localPort = tok ? atoi(tok) : 0;
+    tok = strtok(NULL, delim); // <tetype> 1 is server side
+    if (linkId >= LINKS_COUNT)
+      continue;
+    if (tok && *tok == '1' && type && strcmp_P(type, PSTR("UDP")) && incomingLink(linkId, localPort)) {
+      LOG_INFO_PRINT_PREFIX();
+      LOG_INFO_PRINT(F("adopted linkId "));
+      LOG_INFO_PRINTLN(linkId);
+      if (!warmServerPort) { // AT1 has no AT+CIPSERVER?
+        warmServerPort = localPort;
+      }
+    } else {
+      clientLinks |= (1 << linkId);
+    }
+  }
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
+    if (clientLinks & (1 << linkId)) {
+      LinkInfo& link = linkInfo[linkId];
+      link.flags = LINK_CONNECTED;
+      link.reuseKey = 0;
+      close(linkId | link.serialId);
+    }
+  }
+  return true;
+}
+
+/**
+ * settings common for reset and warm start
+ */
+bool EspAtDrvClass::configure() {
+  dataInfo = false;
+#ifdef WIFIESPAT1
+  sslBufferSize = 0;
+  dataInfo = simpleCommand(PSTR("AT+CIPDINFO=1")); // remote IP and port of UDP message in +IPD
+#else
+  for (int i = 0; i < LINKS_COUNT; i++) {
+    linkInfo[i].sslConfigHash = 0;
+  }
+#endif
 
 #ifndef WIFIESPAT1 //AT2
    if (!simpleCommand(PSTR("AT+SYSSTORE=0"))) {// our default is persistent false
@@ -106,6 +354,7 @@ bool EspAtDrvClass::reset(int8_t resetPin) {
      LOG_WARN_PRINT_PREFIX();
      LOG_WARN_PRINTLN(F("Error setting store mode. Is the firmware AT2?"));
    }
+   simpleCommand(PSTR("AT+SYSMSG=2")); // +LINK_CONN with local port of incoming connection
 #endif
 
   // read default wifi mode
@@ -120,10 +369,59 @@ bool EspAtDrvClass::reset(int8_t resetPin) {
 }
 
 void EspAtDrvClass::maintain() {
+  closeExpiredLinks();
   lastErrorCode = EspAtDrvError::NO_ERROR;
+  while (apScanCallback) { // the firmware is busy with the AP scan. wait for the end of the list
+    readRX(nullptr);
+    if (apScanCallback && millis() - apScanStart > AP_SCAN_TIMEOUT) {
+      LOG_ERROR_PRINT_PREFIX();
+      LOG_ERROR_PRINTLN(F("AP scan timeout"));
+      apScanCallback = nullptr;
+      lastErrorCode = EspAtDrvError::AT_NOT_RESPONDIG;
+    }
+  }
   readRX(nullptr, false);
 }
 
+/**
+ * events are collected in readRX and fired only here,
+ * so a callback never interrupts a running AT command
+ */
+void EspAtDrvClass::processEvents() {
+  if (apScanCallback) { // only collect the AP scan results without waiting
+    readRX(nullptr);
+    return;
+  }
+  maintain();
+  if (firingEvents) // processEvents() invoked in a callback
+    return;
+  firingEvents = true;
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
+    LinkInfo& link = linkInfo[linkId];
+    uint8_t events = link.events;
+    if (!events)
+      continue;
+    link.events = 0;
+    if ((events & LINK_EVENT_CONNECT) && link.isIncoming()) { // the server's callback is used for its links
+      bool linksChecked = false;
+      ServerInfo* server = serverInfo(incomingLinkPort(linkId, linksChecked));
+      link.eventCallback = (server != nullptr) ? server->eventCallback : nullptr;
+    }
+    if (link.eventCallback != nullptr) {
+      LOG_INFO_PRINT_PREFIX();
+      LOG_INFO_PRINT(F("events "));
+      LOG_INFO_PRINT(events);
+      LOG_INFO_PRINT(F(" on link "));
+      LOG_INFO_PRINTLN(linkId);
+      link.eventCallback(linkId | link.serialId, events);
+    }
+    if ((events & LINK_EVENT_CLOSE) && !link.isConnected()) {
+      link.eventCallback = nullptr;
+    }
+  }
+  firingEvents = false;
+}
+
 bool EspAtDrvClass::firmwareVersion(char* buff) {
   maintain();
 
@@ -205,20 +503,7 @@ uint8_t EspAtDrvClass::listAP(WiFiApData apData[], uint8_t size) {
   uint8_t count = 0;
   bool found = sendCommand(PSTR("+CWLAP"), true, true);
   while (found) {
-    WiFiApData& r = apData[count];
-    const char* delims = ",:\")";
-    char* tok = strtok(buffer + strlen("+CWLAP:("), delims); // <enc>
-    r.enc = atoi(tok);
-    tok = strtok(NULL, delims); // <ssid>
-    strcpy(r.ssid, tok);
-    tok = strtok(NULL, delims); // <rssi>
-    r.rssi = atoi(tok);
-    for (int i = 0; i < 6; i++) {
-      tok = strtok(NULL, delims); // <bssid>[i]
-      r.bssid[i] = strtoul(tok, NULL, 16);
-    }
-    tok = strtok(NULL, delims); // <channel>
-    r.channel = atoi(tok);
+    parseAP(apData[count]);
     count++;
     if (count == size)
       break;
@@ -230,6 +515,52 @@ uint8_t EspAtDrvClass::listAP(WiFiApData apData[], uint8_t size) {
   return count;
 }
 
+/**
+ * the results are parsed in readRX and the callback is invoked there.
+ * the callback must not call functions of the driver.
+ * commands invoked while the scan runs wait for its end
+ */
+bool EspAtDrvClass::startListAP(EspAtApScanCallback callback, const char* ssid, uint8_t channel) {
+  maintain();
+
+  LOG_INFO_PRINT_PREFIX();
+  LOG_INFO_PRINTLN(F("start list AP"));
+
+  uint8_t mode = wifiMode | WIFI_MODE_STA; // turn on STA, leave SoftAP as it is
+  if (!setWifiMode(mode, false))
+    return false;
+  if (!simpleCommand(PSTR("AT+CWLAPOPT=1,31"))) // sort and first 5 values (0b0000011111)
+    return false;
+  cmd->print(F("AT+CWLAP"));
+  if (ssid) {
+    cmd->print(F("=\""));
+    cmd->print(ssid);
+    cmd->print('"');
+  }
+  LOG_DEBUG_PRINT(F(" ...sent"));
+  cmd->println();
+  apScanCallback = callback;
+  apScanChannel = channel;
+  apScanStart = millis();
+  return true;
+}
+
+void EspAtDrvClass::parseAP(WiFiApData& r) {
+  const char* delims = ",:\")";
+  char* tok = strtok(buffer + strlen("+CWLAP:("), delims); // <enc>
+  r.enc = atoi(tok);
+  tok = strtok(NULL, delims); // <ssid>
+  strcpy(r.ssid, tok);
+  tok = strtok(NULL, delims); // <rssi>
+  r.rssi = atoi(tok);
+  for (int i = 0; i < 6; i++) {
+    tok = strtok(NULL, delims); // <bssid>[i]
+    r.bssid[i] = strtoul(tok, NULL, 16);
+  }
+  tok = strtok(NULL, delims); // <channel>
+  r.channel = atoi(tok);
+}
+
 bool EspAtDrvClass::staStaticIp(const IPAddress& ip, const IPAddress& gw, const IPAddress& nm) {
   maintain();
 
@@ -389,8 +720,38 @@ bool EspAtDrvClass::dnsQuery(IPAddress& dns1, IPAddress& dns2) {
   return readOK();
 }
 
+/**
+ * with AT2 if the last apQuery was for the same SSID, the join is first tried
+ * with the BSSID of that AP, with fast scan and a short timeout.
+ * if it fails, the normal join follows.
+ * not for persistent join, the firmware would store the BSSID for autoconnect
+ */
 bool EspAtDrvClass::joinAP(const char* ssid, const char* password, const uint8_t* bssid) {
+#ifndef WIFIESPAT1
+  uint32_t ssidHash = (ssid && !persistent) ? (fnv1a(2166136261UL, (const uint8_t*) ssid, strlen(ssid)) | 1) : 0;
+  if (ssidHash && !bssid && lastAP.ssidHash == ssidHash) {
+    if (joinAP(ssid, password, lastAP.bssid, true))
+      return true;
+    lastAP.ssidHash = 0; // the AP is not available
+  }
+#endif
+  if (!joinAP(ssid, password, bssid, false))
+    return false;
+#ifndef WIFIESPAT1
+  if (ssidHash) { // remember the AP for next join
+    uint8_t ch;
+    int8_t rssi;
+    apQuery(nullptr, lastAP.bssid, ch, rssi);
+  }
+#endif
+  return true;
+}
+
+bool EspAtDrvClass::joinAP(const char* ssid, const char* password, const uint8_t* bssid, bool fast) {
   maintain();
+#ifdef WIFIESPAT1
+  (void) fast; // AT1 AT+CWJAP has no scan mode and timeout
+#endif
 
   LOG_INFO_PRINT_PREFIX();
   LOG_INFO_PRINT(F("join AP "));
@@ -414,20 +775,26 @@ bool EspAtDrvClass::joinAP(const char* ssid, const char* password, const uint8_t
   cmd->print((FSH_P) QOUT_COMMA_QOUT);
   if (password) {
     cmd->print(password);
-    if (bssid) {
-      cmd->print((FSH_P) QOUT_COMMA_QOUT);
-      for (int i = 0; i < 6; i++) {
-        if (bssid[i] < 16) {
-          cmd->print('0');
-        }
-        cmd->print(bssid[i], HEX);
-        if (i > 0) {
-          cmd->print(':');
-        }
+  }
+  if (bssid) {
+    cmd->print((FSH_P) QOUT_COMMA_QOUT);
+    for (int i = 0; i < 6; i++) {
+      if (i > 0) {
+        cmd->print(':');
       }
+      if (bssid[i] < 16) {
+        cmd->print('0');
+      }
+      cmd->print(bssid[i], HEX);
     }
   }
   cmd->print('"');
+#ifndef WIFIESPAT1
+  if (fast) { // <pci_en>,<reconn_interval>,<listen_interval>,<scan_mode> 0 is fast scan,<jap_timeout>
+    cmd->print(F(",0,1,3,0,"));
+    cmd->print(FAST_JOIN_TIMEOUT);
+  }
+#endif
  }
   if (!sendCommand())
     return false;
@@ -539,12 +906,16 @@ bool EspAtDrvClass::apQuery(char* ssid, uint8_t* bssid, uint8_t& channel, int8_t
   if (ssid != nullptr) {
     strcpy(ssid, tok);
   }
+  uint32_t ssidHash = fnv1a(2166136261UL, (const uint8_t*) tok, strlen(tok)) | 1;
   for (int i = 0; i < 6; i++) {
     tok = strtok(NULL, delims); // <bssid>[i]
     bssid[i] = strtol(tok, NULL, 16);
   }
   tok = strtok(NULL, delims); // <channel>
   channel = atoi(tok);
+  lastAP.ssidHash = ssidHash; // for fast join
+  memmove(lastAP.bssid, bssid, 6); // bssid can be lastAP.bssid
+  lastAP.channel = channel;
   tok = strtok(NULL, delims); // <rssi>
   rssi = atol(tok);
   return readOK();
@@ -852,18 +1223,35 @@ bool EspAtDrvClass::serverBegin(uint16_t port, uint8_t maxConnCount, uint16_t se
   LOG_INFO_PRINT(F("begin server at port "));
   LOG_INFO_PRINTLN(port);
 
-  cmd->print(F("AT+CIPSERVERMAXCONN="));
-  cmd->print(maxConnCount);
-  if (!sendCommand())
-    return false;
-  cmd->print(F("AT+CIPSERVER=1,"));
-  cmd->print(port);
-  if (ssl) {
-    cmd->print(F(",\"SSL\","));
-    cmd->print(ca);
+  ServerInfo* server = serverInfo(port);
+  if (server == nullptr) {
+    server = serverInfo(0); // unused entry
+    if (server == nullptr) {
+      LOG_ERROR_PRINT_PREFIX();
+      LOG_ERROR_PRINTLN(F("servers table is full"));
+      return false;
+    }
   }
-  if (!sendCommand())
-    return false;
+
+  if (port == warmServerPort) { // still running in the firmware. it would reject AT+CIPSERVERMAXCONN
+    LOG_INFO_PRINT_PREFIX();
+    LOG_INFO_PRINTLN(F("server adopted from warm start"));
+    warmServerPort = 0;
+  } else {
+    cmd->print(F("AT+CIPSERVERMAXCONN="));
+    cmd->print(maxConnCount);
+    if (!sendCommand())
+      return false;
+    cmd->print(F("AT+CIPSERVER=1,"));
+    cmd->print(port);
+    if (ssl) {
+      cmd->print(F(",\"SSL\","));
+      cmd->print(ca);
+    }
+    if (!sendCommand())
+      return false;
+  }
+  server->port = port;
   cmd->print(F("AT+CIPSTO="));
   cmd->print(serverTimeout);
   return sendCommand();
@@ -873,37 +1261,331 @@ bool EspAtDrvClass::serverEnd(uint16_t port) {
   maintain();
   LOG_INFO_PRINT_PREFIX();
   LOG_INFO_PRINTLN(F("stop server"));
-#ifdef WIFIESPAT_MULTISERVER
-  cmd->print(F("AT+CIPSERVER=0,"));
-  cmd->print(port);
-  return sendCommand();
-#else
+  ServerInfo* server = serverInfo(port);
+  if (server != nullptr) {
+    *server = ServerInfo();
+  }
+  bool otherServers = false;
+  for (int i = 0; i < SERVERS_COUNT; i++) {
+    if (servers[i].port) {
+      otherServers = true;
+    }
+  }
+  if (otherServers) { // firmware with multiple servers
+    cmd->print(F("AT+CIPSERVER=0,"));
+    cmd->print(port);
+    return sendCommand();
+  }
   return simpleCommand(PSTR("AT+CIPSERVER=0"));
-#endif
 }
 
 uint8_t EspAtDrvClass::newClientLinkId(uint16_t serverPort) {
   maintain();
+  for (uint8_t i = 0; i < acceptQueueLength; i++) {
+    if (!linkInfo[acceptQueue[i]].localPort) { // checkLinks() can change the queue, so not in the scan
+      checkLinks(); // reads the local port of all links
+      break;
+    }
+  }
+  uint8_t i = 0;
+  while (i < acceptQueueLength) {
+    uint8_t linkId = acceptQueue[i];
+    LinkInfo& link = linkInfo[linkId];
+    if (!link.isIncoming() || link.isClosing()) { // closed before accepted
+      acceptQueueRemove(i);
+      continue;
+    }
+    if (serverPort != link.localPort) {
+      i++;
+      continue;
+    }
+    acceptQueueRemove(i);
+    LOG_INFO_PRINT_PREFIX();
+    LOG_INFO_PRINT(F("accepted incoming linkId "));
+    LOG_INFO_PRINT(linkId);
+    LOG_INFO_PRINT(F(" with serialId "));
+    LOG_INFO_PRINTLN(link.serialId);
+    link.flags &= ~LINK_IS_INCOMING;
+    if (link.eventCallback == nullptr) { // accepted before processEvents() attached the server's callback
+      ServerInfo* server = serverInfo(serverPort);
+      link.eventCallback = (server != nullptr) ? server->eventCallback : nullptr;
+    }
+    return linkId | link.serialId;
+  }
+  return NO_LINK;
+}
+
+/**
+ * a new incoming connection from <id>,CONNECT or +LINK_CONN.
+ * returns false if the link is in use (the notification is for an outgoing connection)
+ */
+bool EspAtDrvClass::incomingLink(uint8_t linkId, uint16_t localPort) {
+  LinkInfo& link = linkInfo[linkId];
+  if (link.available != 0 || (link.isConnected() && !link.isClosing())) // (we could miss CLOSED)
+    return false;
+  link.flags = LINK_CONNECTED | LINK_IS_INCOMING;
+  link.reuseKey = 0;
+  link.localPort = localPort;
+  link.lastActivity = millis();
+  link.incrementSerialId();
+  link.events |= LINK_EVENT_CONNECT;
+  link.eventCallback = nullptr;
+  acceptQueueAdd(linkId);
+  TRACE(INCOMING, linkId, localPort);
+  return true;
+}
+
+/**
+ * an incoming connection found by the links state polling, CONNECT was missed.
+ * localPort 0 is unknown, a stale port of a previous use of the link is not kept. it is then read with AT+CIPSTATUS
+ */
+void EspAtDrvClass::missedIncomingLink(uint8_t linkId, uint16_t localPort) {
+  LinkInfo& link = linkInfo[linkId];
+  COUNT_TRAFFIC(syncRecoveries);
+  TRACE(MISSED_CONNECT, linkId, localPort);
+  link.flags = LINK_CONNECTED | LINK_IS_INCOMING;
+  link.reuseKey = 0;
+  link.localPort = localPort;
+  link.lastActivity = millis();
+  link.incrementSerialId();
+  link.events |= LINK_EVENT_CONNECT;
+  link.eventCallback = nullptr;
+  acceptQueueAdd(linkId);
+}
+
+void EspAtDrvClass::acceptQueueAdd(uint8_t linkId) {
+  for (uint8_t i = 0; i < acceptQueueLength; i++) {
+    if (acceptQueue[i] == linkId) { // a previous connection on the link wasn't accepted
+      acceptQueueRemove(i);
+      break;
+    }
+  }
+  acceptQueue[acceptQueueLength++] = linkId;
+}
+
+void EspAtDrvClass::acceptQueueRemove(uint8_t index) {
+  acceptQueueLength--;
+  for (uint8_t i = index; i < acceptQueueLength; i++) {
+    acceptQueue[i] = acceptQueue[i + 1];
+  }
+}
+
+/**
+ * one maintain() and at most one sync for all links,
+ * instead of one for every client's available()
+ */
+void EspAtDrvClass::pollLinks(EspAtLinksState& state, uint16_t serverPort) {
+  maintain();
+
+#ifndef ESPATDRV_ASSUME_FLOW_CONTROL
   for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
     LinkInfo& link = linkInfo[linkId];
-    if (link.isIncoming() && !link.isClosing()) {
-#ifdef WIFIESPAT_MULTISERVER
-      if (!link.localPort) {
-        checkLinks();
-      }
-      if (serverPort != link.localPort)
-        continue;
+    if (link.isConnected() && !link.isClosing() && link.available == 0) {
+      syncLinkInfo();
+      break;
+    }
+  }
 #endif
-      LOG_INFO_PRINT_PREFIX();
-      LOG_INFO_PRINT(F("accepted incoming linkId "));
-      LOG_INFO_PRINT(linkId);
-      LOG_INFO_PRINT(F(" with serialId "));
-      LOG_INFO_PRINTLN(link.serialId);
-      link.flags &= ~LINK_IS_INCOMING;
-      return linkId | link.serialId;
+
+  bool linksChecked = false;
+  state = EspAtLinksState();
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
+    LinkInfo& link = linkInfo[linkId];
+    uint8_t bit = (1 << linkId);
+    if (link.available) {
+      state.readable |= bit;
+    }
+    if (!link.isConnected() || link.isClosing()) {
+      state.closed |= bit;
+      continue;
     }
+    state.writable |= bit;
+    if (!link.isIncoming() || serverPort != incomingLinkPort(linkId, linksChecked))
+      continue;
+    state.incoming |= bit;
   }
-  return NO_LINK;
+}
+
+ServerInfo* EspAtDrvClass::serverInfo(uint16_t port) {
+  for (int i = 0; i < SERVERS_COUNT; i++) {
+    if (servers[i].port == port)
+      return &servers[i];
+  }
+  return nullptr;
+}
+
+/**
+ * if only one server is running, an incoming connection can only be for it
+ */
+uint16_t EspAtDrvClass::singleServerPort() {
+  uint16_t port = 0;
+  for (int i = 0; i < SERVERS_COUNT; i++) {
+    if (servers[i].port) {
+      if (port)
+        return 0;
+      port = servers[i].port;
+    }
+  }
+  return port;
+}
+
+/**
+ * the local port of an incoming link is known from +LINK_CONN (AT2)
+ * or if only one server was running at CONNECT. otherwise it is read
+ * with AT+CIPSTATUS, at most once for the caller's scan of links
+ */
+uint16_t EspAtDrvClass::incomingLinkPort(uint8_t linkId, bool& linksChecked) {
+  LinkInfo& link = linkInfo[linkId];
+  if (!link.localPort && !linksChecked) {
+    checkLinks(); // reads the local port of all links
+    linksChecked = true;
+  }
+  return link.localPort;
+}
+
+bool EspAtDrvClass::setServerEventCallback(uint16_t port, EspAtLinkEventCallback callback) {
+  ServerInfo* server = serverInfo(port);
+  if (server == nullptr)
+    return false; // server is not running
+  server->eventCallback = callback;
+  return true;
+}
+
+uint8_t EspAtDrvClass::serverLinkIds(uint16_t serverPort, uint8_t linkIds[]) {
+  maintain();
+  uint8_t count = 0;
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
+    LinkInfo& link = linkInfo[linkId];
+    if (link.isConnected() && !link.isClosing() && !link.isIncoming() && !link.isUdpListener()
+        && link.localPort == serverPort) {
+      linkIds[count++] = linkId | link.serialId;
+    }
+  }
+  return count;
+}
+
+/**
+ * returns the least recently active accepted link of the server, which is idle at least idleTime.
+ * idleTime 0 returns NO_LINK. with whenFull only if all links are in use, so a new connection would not get a link.
+ * (at maxConnCount the firmware refuses new clients of the server, so no one waits for a link)
+ */
+uint8_t EspAtDrvClass::idleLinkId(uint16_t serverPort, unsigned long idleTime, bool whenFull) {
+  maintain();
+
+  if (!idleTime) // a just used connection would be closed. 0 is disabled
+    return NO_LINK;
+
+  uint8_t usedCount = 0;
+  int idleLinkId = -1;
+  unsigned long now = millis();
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
+    LinkInfo& link = linkInfo[linkId];
+    if (link.isConnected() || link.isClosing() || link.available) {
+      usedCount++;
+    }
+    if (!link.isConnected() || link.isClosing() || link.isUdpListener() || link.localPort != serverPort)
+      continue;
+    if (link.isIncoming() || now - link.lastActivity < idleTime) // not accepted or not idle
+      continue;
+    if (idleLinkId == -1 || now - link.lastActivity > now - linkInfo[idleLinkId].lastActivity) {
+      idleLinkId = linkId;
+    }
+  }
+  if (idleLinkId == -1 || (whenFull && usedCount < LINKS_COUNT))
+    return NO_LINK;
+  LOG_INFO_PRINT_PREFIX();
+  LOG_INFO_PRINT(F("idle linkId "));
+  LOG_INFO_PRINTLN(idleLinkId);
+  return idleLinkId | linkInfo[idleLinkId].serialId;
+}
+
+bool EspAtDrvClass::setLinkEventCallback(uint8_t linkId, EspAtLinkEventCallback callback) {
+  linkId = checkLinkId(linkId);
+  if (linkId == NO_LINK)
+    return false;
+  linkInfo[linkId].eventCallback = callback;
+  return true;
+}
+
+uint8_t EspAtDrvClass::connectSSL(const char* host, uint16_t port, const EspAtSslConfig* config) {
+  sslConfig = config;
+  uint8_t linkId = connect("SSL", host, port);
+  sslConfig = nullptr;
+  return linkId;
+}
+
+/**
+ * settings already applied are not sent again.
+ * AT1 has only the global AT+CIPSSLSIZE, AT2 has the settings per link.
+ * with AT2 a null config or a config without sni or alpn resets
+ * the settings left on the link by a previous connection
+ */
+bool EspAtDrvClass::applySslConfig(uint8_t linkId, const EspAtSslConfig* config) {
+#ifdef WIFIESPAT1
+  (void) linkId; // AT+CIPSSLSIZE is global
+  if (!config || config->bufferSize == 0 || config->bufferSize == sslBufferSize)
+    return true;
+  cmd->print(F("AT+CIPSSLSIZE="));
+  cmd->print(config->bufferSize);
+  if (!sendCommand())
+    return false;
+  sslBufferSize = config->bufferSize;
+  return true;
+#else
+  LinkInfo& link = linkInfo[linkId];
+  uint32_t hash = sslConfigHash(config);
+  if (hash == link.sslConfigHash)
+    return true;
+  LOG_INFO_PRINT_PREFIX();
+  LOG_INFO_PRINT(F("SSL config for link "));
+  LOG_INFO_PRINTLN(linkId);
+  link.sslConfigHash = SSL_CONFIG_UNKNOWN;
+  uint8_t authMode = config ? config->authMode : 0;
+  const char* sni = config ? config->sni : nullptr;
+  const char* alpn = config ? config->alpn : nullptr;
+  cmd->print(F("AT+CIPSSLCCONF="));
+  cmd->print(linkId);
+  cmd->print(',');
+  cmd->print(authMode);
+  if (authMode) {
+    cmd->print(',');
+    cmd->print(config->pkiNumber);
+    cmd->print(',');
+    cmd->print(config->caNumber);
+  }
+  if (!sendCommand())
+    return false;
+  if (sni && *sni) { // the firmware rejects an empty SNI. AT+CIPSSLCCONF resets it
+    cmd->print(F("AT+CIPSSLCSNI="));
+    cmd->print(linkId);
+    cmd->print(F(",\""));
+    cmd->print(sni);
+    cmd->print('"');
+    if (!sendCommand())
+      return false;
+  }
+  cmd->print(F("AT+CIPSSLCALPN="));
+  cmd->print(linkId);
+  if (alpn) {
+    cmd->print(F(",1,\""));
+    cmd->print(alpn);
+    cmd->print('"');
+  } else {
+    cmd->print(F(",0"));
+  }
+  if (!sendCommand())
+    return false;
+  link.sslConfigHash = hash;
+  return true;
+#endif
+}
+
+bool EspAtDrvClass::setCloseOnIdle(uint8_t linkId) {
+  linkId = checkLinkId(linkId);
+  if (linkId == NO_LINK)
+    return false;
+  linkInfo[linkId].flags |= LINK_CLOSE_IDLE;
+  return true;
 }
 
 uint8_t EspAtDrvClass::connect(const char* type, const char* host, uint16_t port,
@@ -913,7 +1595,18 @@ uint8_t EspAtDrvClass::connect(const char* type, const char* host, uint16_t port
     uint16_t udpLocalPort) {
   maintain();
 
+  uint32_t reuseKey = 0;
+  if (linkReuseTime && strcmp_P(type, PSTR("UDP"))) {
+    reuseKey = linkReuseKey(type, host, port, sslConfigHash(sslConfig));
+    uint8_t linkId = parkedLinkId(reuseKey);
+    if (linkId != NO_LINK)
+      return linkId;
+  }
+
   uint8_t linkId = freeLinkId();
+  if (linkId == NO_LINK && (closeParkedLink() || closeIdleLink())) { // make room
+    linkId = freeLinkId();
+  }
   if (linkId == NO_LINK)
     return NO_LINK;
 
@@ -937,6 +1630,8 @@ uint8_t EspAtDrvClass::connect(const char* type, const char* host, uint16_t port
     lastErrorCode = EspAtDrvError::LINK_ALREADY_CONNECTED;
     return NO_LINK;
   }
+  if (!strcmp_P(type, PSTR("SSL")) && !applySslConfig(linkId, sslConfig))
+    return NO_LINK;
   cmd->print(F("AT+CIPSTART="));
   cmd->print(linkId);
   cmd->print(F(",\""));
@@ -949,13 +1644,16 @@ uint8_t EspAtDrvClass::connect(const char* type, const char* host, uint16_t port
     cmd->print(',');
     cmd->print(udpLocalPort);
     cmd->print(",2");
-#ifdef WIFIESPAT_MULTISERVER
-    link.localPort = udpLocalPort;
-  } else {
-    link.localPort = 0;
-#endif
+  } else if (tcpKeepAlive && strcmp_P(type, PSTR("UDP"))) { // a dead peer is then reported with CLOSED
+    cmd->print(',');
+    cmd->print(tcpKeepAlive);
   }
+  link.localPort = udpLocalPort;
+  link.reuseKey = reuseKey;
   link.flags = LINK_CONNECTED;
+  link.events = 0;
+  link.eventCallback = nullptr;
+  link.lastActivity = millis();
   if (!sendCommand()) {
     link.flags = 0;
     return NO_LINK;
@@ -967,6 +1665,7 @@ uint8_t EspAtDrvClass::connect(const char* type, const char* host, uint16_t port
 #endif    
   }
   link.incrementSerialId();
+  TRACE(CONNECT, linkId, port);
   LOG_DEBUG_PRINT_PREFIX();
   LOG_DEBUG_PRINT(F(" serialId "));
   LOG_DEBUG_PRINT(link.serialId);
@@ -975,6 +1674,102 @@ uint8_t EspAtDrvClass::connect(const char* type, const char* host, uint16_t port
   return linkId | link.serialId;
 }
 
+/**
+ * hash of type, host, port and the SSL config, so a parked link
+ * is not reused with different SSL settings
+ */
+uint32_t EspAtDrvClass::linkReuseKey(const char* type, const char* host, uint16_t port, uint32_t sslHash) {
+  uint32_t hash = fnv1a(2166136261UL, (const uint8_t*) type, strlen(type));
+  hash = fnv1a(hash, (const uint8_t*) host, strlen(host));
+  uint8_t p[6] = {(uint8_t) (port & 0xFF), (uint8_t) (port >> 8),
+      (uint8_t) sslHash, (uint8_t) (sslHash >> 8), (uint8_t) (sslHash >> 16), (uint8_t) (sslHash >> 24)};
+  hash = fnv1a(hash, p, 6);
+  return hash ? hash : 1;
+}
+
+/**
+ * returns a parked link to the same host and port,
+ * if it is still connected and has no unexpected data
+ */
+uint8_t EspAtDrvClass::parkedLinkId(uint32_t reuseKey) {
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
+    LinkInfo& link = linkInfo[linkId];
+    if (!link.isParked() || link.reuseKey != reuseKey)
+      continue;
+    if (link.available > 0 || millis() - link.lastActivity > linkReuseTime) {
+      closeParkedLink(linkId);
+      continue;
+    }
+    link.flags &= ~LINK_PARKED;
+    link.events = 0;
+    link.lastActivity = millis();
+    LOG_INFO_PRINT_PREFIX();
+    LOG_INFO_PRINT(F("reuse link "));
+    LOG_INFO_PRINTLN(linkId);
+    return linkId | link.serialId;
+  }
+  return NO_LINK;
+}
+
+bool EspAtDrvClass::closeParkedLink(uint8_t linkId) {
+  if (linkId == NO_LINK) {
+    unsigned long now = millis();
+    for (int i = 0; i < LINKS_COUNT; i++) {
+      LinkInfo& link = linkInfo[i];
+      if (link.isParked() && (linkId == NO_LINK || now - link.lastActivity > now - linkInfo[linkId].lastActivity)) {
+        linkId = i;
+      }
+    }
+    if (linkId == NO_LINK)
+      return false;
+  }
+  LinkInfo& link = linkInfo[linkId];
+  link.flags &= ~LINK_PARKED;
+  link.reuseKey = 0;
+  return close(linkId | link.serialId);
+}
+
+/**
+ * closes the least recently active link set with setCloseOnIdle
+ */
+bool EspAtDrvClass::closeIdleLink() {
+  uint8_t linkId = NO_LINK;
+  unsigned long now = millis();
+  for (int i = 0; i < LINKS_COUNT; i++) {
+    LinkInfo& link = linkInfo[i];
+    if (link.isCloseIdle() && link.isConnected() && !link.isClosing()
+        && (linkId == NO_LINK || now - link.lastActivity > now - linkInfo[linkId].lastActivity)) {
+      linkId = i;
+    }
+  }
+  if (linkId == NO_LINK)
+    return false;
+  return close(linkId | linkInfo[linkId].serialId);
+}
+
+/**
+ * closes idle links set with setCloseOnIdle and parked links after linkReuseTime.
+ * runs in maintain(), so at start of every command
+ */
+void EspAtDrvClass::closeExpiredLinks() {
+  if (closingLinks) // close() calls maintain()
+    return;
+  closingLinks = true;
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
+    LinkInfo& link = linkInfo[linkId];
+    if (link.isCloseIdle() && link.isConnected() && !link.isClosing()
+        && millis() - link.lastActivity > WIFIESPAT_UDP_SENDER_IDLE_TIMEOUT) {
+      LOG_INFO_PRINT_PREFIX();
+      LOG_INFO_PRINT(F("idle link "));
+      LOG_INFO_PRINTLN(linkId);
+      close(linkId | link.serialId);
+    } else if (link.isParked() && millis() - link.lastActivity > linkReuseTime) {
+      closeParkedLink(linkId);
+    }
+  }
+  closingLinks = false;
+}
+
 uint8_t EspAtDrvClass::checkLinkId(uint8_t id) {
   if (id == NO_LINK) {
     LOG_ERROR_PRINT_PREFIX();
@@ -1015,13 +1810,25 @@ bool EspAtDrvClass::close(uint8_t linkId, bool abort) {
     return false;
 
   LinkInfo& link = linkInfo[linkId];
+  if (!abort && link.reuseKey && linkReuseTime && link.isConnected() && !link.isClosing()
+      && !link.isParked() && link.available == 0) { // keep it open for next connect to same host and port
+    LOG_INFO_PRINT_PREFIX();
+    LOG_INFO_PRINTLN(F("link is parked"));
+    link.flags |= LINK_PARKED;
+    link.eventCallback = nullptr;
+    link.incrementSerialId(); // the linkId of the closed client is not valid anymore
+    link.lastActivity = millis();
+    return true;
+  }
   link.available = 0;
+  link.eventCallback = nullptr; // closed by the sketch
   if (!link.isConnected()) {
     LOG_INFO_PRINT_PREFIX();
     LOG_INFO_PRINTLN(F("link is already closed"));
     return true;
   }
   link.flags |= LINK_CLOSING;
+  TRACE(CLOSE, linkId, abort);
   if (abort) {
     cmd->print(F("AT+CIPCLOSEMODE="));
     cmd->print(linkId);
@@ -1039,10 +1846,8 @@ uint16_t EspAtDrvClass::localPortQuery(uint8_t linkId) {
   if (linkId == NO_LINK)
     return 0;
 
-#ifdef WIFIESPAT_MULTISERVER
   if (linkInfo[linkId].localPort != 0)
     return linkInfo[linkId].localPort;
-#endif
   IPAddress remoteIP;
   uint16_t remotePort;
   uint16_t localPort = 0;
@@ -1079,9 +1884,7 @@ bool EspAtDrvClass::remoteParamsQuery(uint8_t linkId, IPAddress& remoteIP, uint1
         remotePort = atoi(tok);
         tok = strtok(NULL, delim); // <local port>
         localPort = atoi(tok);
-#ifdef WIFIESPAT_MULTISERVER
         linkInfo[linkId].localPort = localPort;
-#endif
         readOK();
         return true;
       }
@@ -1151,6 +1954,7 @@ size_t EspAtDrvClass::recvData(uint8_t linkId, uint8_t data[], size_t buffSize)
     LOG_ERROR_PRINT_PREFIX();
     LOG_ERROR_PRINT(F("error receiving on link "));
     LOG_ERROR_PRINTLN(linkId);
+    TRACE(RECV_FAIL, linkId, 0);
     link.available = 0;
     lastErrorCode = EspAtDrvError::RECEIVE;
     return 0;
@@ -1162,12 +1966,17 @@ size_t EspAtDrvClass::recvData(uint8_t linkId, uint8_t data[], size_t buffSize)
   size_t lt = serial->readBytesUntil(',', buffer, 6);
   buffer[lt] = 0;
   size_t len = atol(buffer);
+  if (dataInfo) { // skip remote IP and port
+    serial->readBytesUntil(',', buffer, 18);
+    serial->readBytesUntil(',', buffer, 6);
+  }
 #endif
   size_t l = serial->readBytes(data, len);
   if (l != len) { //timeout
     LOG_ERROR_PRINT_PREFIX();
     LOG_ERROR_PRINT(F("error receiving on link "));
     LOG_ERROR_PRINTLN(linkId);
+    TRACE(RECV_FAIL, linkId, 0);
     link.available = 0;
     lastErrorCode = EspAtDrvError::RECEIVE;
     return 0;
@@ -1178,6 +1987,10 @@ size_t EspAtDrvClass::recvData(uint8_t linkId, uint8_t data[], size_t buffSize)
   } else {
     link.available -= len;
   }
+  link.lastActivity = millis();
+  COUNT_LINK_TRAFFIC(linkId, recvCount, 1);
+  COUNT_LINK_TRAFFIC(linkId, bytesReceived, len);
+  TRACE(RECV, linkId, len);
 
   readOK();
 
@@ -1231,8 +2044,11 @@ size_t EspAtDrvClass::recvDataWithInfo(uint8_t linkId, uint8_t data[], size_t bu
       link.available = len; // the rest of message will not be available
     }
   }
-  if (!simpleCommand(PSTR("AT+CIPDINFO=1")))
-    return 0;
+  if (!dataInfo) { // stays on. recvData and +IPD parsing handle both formats
+    if (!simpleCommand(PSTR("AT+CIPDINFO=1")))
+      return 0;
+    dataInfo = true;
+  }
   cmd->print(F("AT+CIPRECVDATA="));
   cmd->print(linkId);
   cmd->print(',');
@@ -1241,6 +2057,7 @@ size_t EspAtDrvClass::recvDataWithInfo(uint8_t linkId, uint8_t data[], size_t bu
     LOG_ERROR_PRINT_PREFIX();
     LOG_ERROR_PRINT(F("error receiving on link "));
     LOG_ERROR_PRINTLN(linkId);
+    TRACE(RECV_FAIL, linkId, 0);
     link.available = 0;
     lastErrorCode = EspAtDrvError::RECEIVE;
   } else {
@@ -1261,6 +2078,7 @@ size_t EspAtDrvClass::recvDataWithInfo(uint8_t linkId, uint8_t data[], size_t bu
       LOG_ERROR_PRINT_PREFIX();
       LOG_ERROR_PRINT(F("error receiving on link "));
       LOG_ERROR_PRINTLN(linkId);
+      TRACE(RECV_FAIL, linkId, 0);
       link.available = 0;
       lastErrorCode = EspAtDrvError::RECEIVE;
       len = 0;
@@ -1270,6 +2088,10 @@ size_t EspAtDrvClass::recvDataWithInfo(uint8_t linkId, uint8_t data[], size_t bu
       } else {
         link.available -= len;
       }
+      link.lastActivity = millis();
+      COUNT_LINK_TRAFFIC(linkId, recvCount, 1);
+      COUNT_LINK_TRAFFIC(linkId, bytesReceived, len);
+      TRACE(RECV, linkId, len);
       readOK();
 
       LOG_INFO_PRINT_PREFIX();
@@ -1279,7 +2101,6 @@ size_t EspAtDrvClass::recvDataWithInfo(uint8_t linkId, uint8_t data[], size_t bu
       LOG_INFO_PRINTLN(linkId);
     }
   }
-  simpleCommand(PSTR("AT+CIPDINFO=0"));
   return len;
 }
 
@@ -1316,17 +2137,33 @@ size_t EspAtDrvClass::sendData(uint8_t linkId, const uint8_t data[], size_t len,
 
   serial->write(data, len);
 
-  if (!readRX(PSTR("Recv ")))
+  if (!readRX(PSTR("Recv "))) {
+    COUNT_LINK_TRAFFIC(linkId, sendFails, 1);
+    TRACE(SEND_FAIL, linkId, 0);
     return 0;
+  }
   size_t l = atol(buffer + strlen("Recv "));
-  if (!readRX(PSTR("SEND "))) // SEND OK or SEND FAIL
-    return 0;
-  if (strcmp_P(buffer + strlen("SEND "), OK) != 0) {// FAIL
+  bool sent = readRX(PSTR("SEND ")); // SEND OK or SEND FAIL
+#if WIFIESPAT_CMD_STATS
+  cmdStatsEnd();
+#endif
+  if (!sent || strcmp_P(buffer + strlen("SEND "), OK) != 0) {// FAIL
+    COUNT_LINK_TRAFFIC(linkId, sendFails, 1);
+    TRACE(SEND_FAIL, linkId, 0);
+    if (!sent)
+      return 0;
     LOG_ERROR_PRINT_PREFIX();
     LOG_ERROR_PRINTLN(F("failed to send data"));
     lastErrorCode = EspAtDrvError::SEND;
     return 0;
   }
+  COUNT_LINK_TRAFFIC(linkId, sendCount, 1);
+  COUNT_LINK_TRAFFIC(linkId, bytesSent, l);
+  TRACE(SEND, linkId, l);
+  if (l < len) {
+    COUNT_LINK_TRAFFIC(linkId, partialSends, 1);
+  }
+  linkInfo[linkId].lastActivity = millis();
   LOG_INFO_PRINT_PREFIX();
   LOG_INFO_PRINT(F("\tsent "));
   LOG_INFO_PRINT(l);
@@ -1378,23 +2215,39 @@ size_t EspAtDrvClass::sendData(uint8_t linkId, Stream& file, const char* udpHost
     for (size_t i = 0; i < l; i++) {
       serial->write(file.read());
     }
-    if (!readRX(PSTR("Recv ")))
+    if (!readRX(PSTR("Recv "))) {
+      COUNT_LINK_TRAFFIC(linkId, sendFails, 1);
+      TRACE(SEND_FAIL, linkId, 0);
       return 0;
+    }
     size_t sl = atol(buffer + strlen("Recv "));
     len += sl;
-    if (!readRX(PSTR("SEND ")) || strcmp_P(buffer + strlen("SEND "), OK) != 0) {// FAIL
+    bool sent = readRX(PSTR("SEND "));
+#if WIFIESPAT_CMD_STATS
+    cmdStatsEnd();
+#endif
+    if (!sent || strcmp_P(buffer + strlen("SEND "), OK) != 0) {// FAIL
+      COUNT_LINK_TRAFFIC(linkId, sendFails, 1);
+      TRACE(SEND_FAIL, linkId, 0);
       LOG_ERROR_PRINT_PREFIX();
       LOG_ERROR_PRINT(F("failed to send data at "));
       LOG_ERROR_PRINTLN(len);
       lastErrorCode = EspAtDrvError::SEND;
       return 0;
     }
+    COUNT_LINK_TRAFFIC(linkId, sendCount, 1);
+    COUNT_LINK_TRAFFIC(linkId, bytesSent, sl);
+    TRACE(SEND, linkId, sl);
+    if (sl < l) {
+      COUNT_LINK_TRAFFIC(linkId, partialSends, 1);
+    }
     if (l == MAX_SEND_LENGTH && sl < MAX_SEND_LENGTH) {
       LOG_WARN_PRINT_PREFIX();
       LOG_WARN_PRINT(F("Retardment of sending data at "));
       LOG_WARN_PRINTLN(len);
     }
   }
+  linkInfo[linkId].lastActivity = millis();
   LOG_INFO_PRINT_PREFIX();
   LOG_INFO_PRINT(F("\tsent "));
   LOG_INFO_PRINT(len);
@@ -1438,17 +2291,30 @@ size_t EspAtDrvClass::sendData(uint8_t linkId, SendCallbackFnc callback, const c
   delay(20); // mandatory delay before \\0
   serial->print("\\0"); //end data
 
-  if (!readRX(PSTR("Recv ")))
+  if (!readRX(PSTR("Recv "))) {
+    COUNT_LINK_TRAFFIC(linkId, sendFails, 1);
+    TRACE(SEND_FAIL, linkId, 0);
     return 0;
+  }
   size_t l = atol(buffer + strlen("Recv "));
-  if (!readRX(PSTR("SEND "))) // SEND OK or SEND FAIL
-    return 0;
-  if (strcmp_P(buffer + strlen("SEND "), OK) != 0) {// FAIL
+  bool sent = readRX(PSTR("SEND ")); // SEND OK or SEND FAIL
+#if WIFIESPAT_CMD_STATS
+  cmdStatsEnd();
+#endif
+  if (!sent || strcmp_P(buffer + strlen("SEND "), OK) != 0) {// FAIL
+    COUNT_LINK_TRAFFIC(linkId, sendFails, 1);
+    TRACE(SEND_FAIL, linkId, 0);
+    if (!sent)
+      return 0;
     LOG_ERROR_PRINT_PREFIX();
     LOG_ERROR_PRINTLN(F("failed to send data"));
     lastErrorCode = EspAtDrvError::SEND;
     return 0;
   }
+  COUNT_LINK_TRAFFIC(linkId, sendCount, 1);
+  COUNT_LINK_TRAFFIC(linkId, bytesSent, l);
+  TRACE(SEND, linkId, l);
+  linkInfo[linkId].lastActivity = millis();
   LOG_INFO_PRINT_PREFIX();
   LOG_INFO_PRINT(F("\tsent "));
   LOG_INFO_PRINT(l);
@@ -1666,6 +2532,7 @@ bool EspAtDrvClass::readRX(PGM_P expected, bool bufferData, bool listItem) {
         lastErrorCode = EspAtDrvError::AT_NOT_RESPONDIG;
         return false;
       }
+      TRACE(AT_TIMEOUT, NO_LINK, timeout + 1);
       // next we send an invalid command to AT.
       cmd->println("?");
       // response is:
@@ -1717,21 +2584,51 @@ bool EspAtDrvClass::readRX(PGM_P expected, bool bufferData, bool listItem) {
       LOG_DEBUG_PRINTLN(F(" ...matched"));
       return true;
     }
-    if (strncmp_P(buffer, PSTR("+IPD,"), SL_IPD) == 0) { // startsWith
+    if (apScanCallback && !strncmp_P(buffer, PSTR("+CWLAP:"), strlen("+CWLAP:"))) {
+      WiFiApData ap;
+      parseAP(ap);
+      if (!apScanChannel || ap.channel == apScanChannel) {
+        apScanCallback(ap);
+      }
+      LOG_DEBUG_PRINTLN((FSH_P) PROCESSED);
+    } else if (apScanCallback && (!strcmp_P(buffer, OK) || !strcmp_P(buffer, PSTR("ERROR")))) {
+      apScanCallback = nullptr; // end of the AP list
+      LOG_DEBUG_PRINTLN(F(" ...end of list"));
+    } else if (strncmp_P(buffer, PSTR("+IPD,"), SL_IPD) == 0) { // startsWith
       int8_t linkId = buffer[SL_IPD] - 48;
       size_t len = atol(buffer + SL_IPD + 2);
       if (linkId >= 0 && linkId < LINKS_COUNT && len > 0) {
         LinkInfo& link = linkInfo[linkId];
+        COUNT_LINK_TRAFFIC(linkId, ipdCount, 1);
+        TRACE(IPD, linkId, len);
 #ifdef WIFIESPAT1
         if (!link.isUdpListener()) {
 #endif        
           link.available = len;
+          link.events |= LINK_EVENT_DATA;
+          link.lastActivity = millis();
           LOG_DEBUG_PRINTLN((FSH_P) PROCESSED);
 #ifdef WIFIESPAT1
         } else { // UDP listener
           LOG_DEBUG_PRINTLN(F(":<DATA>"));
-          uint8_t res = link.udpDataCallback->readRxData(serial, len);
+          // +IPD,<id>,<len>,<remote IP>,<remote port> with AT+CIPDINFO=1
+          IPAddress remoteIP;
+          uint16_t remotePort = 0;
+          char* ip = strchr(buffer + SL_IPD + 2, ',');
+          char* port = ip ? strchr(ip + 1, ',') : nullptr;
+          if (port) {
+            *port = 0;
+            remotePort = atol(port + 1);
+            ip++;
+            if (*ip == '"') { // some versions have the IP in quotes
+              ip++;
+              port[-1] = 0;
+            }
+            remoteIP.fromString(ip);
+          }
+          uint8_t res = link.udpDataCallback->readRxData(serial, len, remoteIP, remotePort);
           if (res == EspAtDrvUdpDataCallback::OK) {
+            COUNT_LINK_TRAFFIC(linkId, bytesReceived, len);
             LOG_DEBUG_PRINTLN((FSH_P) PROCESSED);
           } else {
             LOG_DEBUG_PRINTLN(F(" ...error"));
@@ -1743,29 +2640,48 @@ bool EspAtDrvClass::readRX(PGM_P expected, bool bufferData, bool listItem) {
             LOG_ERROR_PRINT(F(" error "));
             LOG_ERROR_PRINTLN(res);
             lastErrorCode = (EspAtDrvError)((uint8_t) EspAtDrvError::UDP_BUSY + (res - 1));
+            TRACE(UDP_ERROR, linkId, res);
           }
         }
 #endif        
 #ifndef ESPATDRV_ASSUME_FLOW_CONTROL
       } else { // +IPD truncated in serial buffer overflow
+        COUNT_TRAFFIC(truncatedIpd);
+        TRACE(IPD_TRUNCATED, NO_LINK, 0);
         LOG_DEBUG_PRINTLN((FSH_P) IGNORED);
 #endif
       }
     } else if (strcmp_P(buffer + 1, PSTR(",CONNECT")) == 0) {
       uint8_t linkId = buffer[0] - 48;
-      LinkInfo& link = linkInfo[linkId];
-      if (link.available == 0 && (!link.isConnected() || link.isClosing())) { // incoming connection (and we could miss CLOSED)
-        link.flags = LINK_CONNECTED | LINK_IS_INCOMING;
-#ifdef WIFIESPAT_MULTISERVER
-        link.localPort = 0;
-#endif
-        link.incrementSerialId();
+      if (incomingLink(linkId, singleServerPort())) {
+        LOG_DEBUG_PRINTLN((FSH_P) PROCESSED);
+      } else {
+        LOG_DEBUG_PRINTLN((FSH_P) IGNORED);
+      }
+    } else if (!strncmp_P(buffer, PSTR("+LINK_CONN:"), strlen("+LINK_CONN:"))) {
+      // +LINK_CONN:<status_type>,<link_id>,"<type>",<c/s>,"<remote_ip>",<remote_port>,<local_port>
+      const char* delims = ",\"";
+      char* tok = strtok(buffer + strlen("+LINK_CONN:"), delims); // <status_type>
+      uint8_t status = atoi(tok);
+      tok = strtok(NULL, delims); // <link_id>
+      uint8_t linkId = atoi(tok);
+      tok = strtok(NULL, delims); // <type>
+      tok = strtok(NULL, delims); // <c/s>
+      bool server = tok && atoi(tok) == 1;
+      tok = strtok(NULL, delims); // <remote_ip>
+      tok = strtok(NULL, delims); // <remote_port>
+      tok = strtok(NULL, delims); // <local_port>
+      if (status == 0 && server && tok && linkId < LINKS_COUNT && incomingLink(linkId, atoi(tok))) {
         LOG_DEBUG_PRINTLN((FSH_P) PROCESSED);
       } else {
         LOG_DEBUG_PRINTLN((FSH_P) IGNORED);
       }
     } else if ((strcmp_P(buffer + 1, PSTR(",CLOSED")) == 0 || strcmp_P(buffer + 1, PSTR(",CONNECT FAIL")) == 0)) {
       uint8_t linkId = buffer[0] - 48;
+      TRACE(CLOSED, linkId, 0);
+      if (linkInfo[linkId].isConnected()) {
+        linkInfo[linkId].events |= LINK_EVENT_CLOSE;
+      }
       linkInfo[linkId].flags = 0;
 #ifndef WIFIESPAT1 //AT2
       linkInfo[linkId].available = 0; // AT2 sends CLOSED only after all data are read
@@ -1789,6 +2705,7 @@ bool EspAtDrvClass::readRX(PGM_P expected, bool bufferData, bool listItem) {
       LOG_ERROR_PRINT(F(" got "));
       LOG_ERROR_PRINTLN(buffer);
       lastErrorCode = EspAtDrvError::AT_ERROR;
+      TRACE(AT_ERROR, NO_LINK, 0);
       return false;
       }
     } else if (!strcmp_P(buffer, PSTR("No AP"))) {
@@ -1830,7 +2747,12 @@ bool EspAtDrvClass::sendCommand(PGM_P expected, bool bufferData, bool listItem)
   // AT command is already printed, but not 'entered' with "\r\n"
   LOG_DEBUG_PRINT(F(" ...sent"));
   cmd->println(); // finish AT command sending
-  return expected ? readRX(expected, bufferData, listItem) : readOK();
+  bool ok = expected ? readRX(expected, bufferData, listItem) : readOK();
+#if WIFIESPAT_CMD_STATS
+  if (!ok || !expected || pgm_read_byte(expected) != '>') // CIPSEND is measured until SEND OK
+    cmdStatsEnd();
+#endif
+  return ok;
 }
 
 bool EspAtDrvClass::simpleCommand(PGM_P command) {
@@ -1838,7 +2760,11 @@ bool EspAtDrvClass::simpleCommand(PGM_P command) {
   cmd->print((FSH_P) command);
   LOG_DEBUG_PRINT(F(" ...sent"));
   cmd->println();
-  return readOK();
+  bool ok = readOK();
+#if WIFIESPAT_CMD_STATS
+  cmdStatsEnd();
+#endif
+  return ok;
 }
 
 bool EspAtDrvClass::setWifiMode(uint8_t mode, bool save) {
@@ -1913,20 +2839,29 @@ bool EspAtDrvClass::recvLenQuery() {
     if (tok == NULL)
       break;
     if (strlen(tok) > 0) {
+      LinkInfo& link = linkInfo[linkId];
+      size_t available = link.available;
 #ifdef WIFIESPAT1
-      linkInfo[linkId].available = atol(tok);
+      link.available = atol(tok);
 #else
-      LinkInfo& link = linkInfo[linkId];
       if (tok[0] == '-') { // AT V2 sends -1 for inactive links
+        if (link.isConnected()) {
+          link.events |= LINK_EVENT_CLOSE;
+        }
         link.flags = 0;
         link.available = 0;
       } else {
         if (!link.isConnected() || link.isClosing()) { // missed incoming connection
-          link.flags = LINK_CONNECTED | LINK_IS_INCOMING;
+          missedIncomingLink(linkId, singleServerPort()); // 0 if more servers run
         }
         link.available = atol(tok);
       }
 #endif
+      if (available == 0 && link.available > 0) { // missed +IPD
+        COUNT_TRAFFIC(syncRecoveries);
+        TRACE(MISSED_IPD, linkId, link.available);
+        link.events |= LINK_EVENT_DATA;
+      }
     }
     tok = strtok(NULL, delim);
   }
@@ -1934,7 +2869,6 @@ bool EspAtDrvClass::recvLenQuery() {
 }
 #endif
 
-#if !defined(ESPATDRV_ASSUME_FLOW_CONTROL) || defined(WIFIESPAT_MULTISERVER)
 bool EspAtDrvClass::checkLinks() {
   maintain();
   cmd->print((FSH_P) AT_CIPSTATUS);
@@ -1944,7 +2878,6 @@ bool EspAtDrvClass::checkLinks() {
   while (readRX(CIPSTATUS, true, true)) {
     uint8_t linkId = buffer[strlen("+CIPSTATUS:")] - 48;
     ok[linkId] = true;
-#ifdef WIFIESPAT_MULTISERVER
     const char* delim = ",\"";
     char* tok = strtok(buffer, delim); // +CIPSTATUS:<link  ID>
     tok = strtok(NULL, delim); // <type>
@@ -1952,22 +2885,24 @@ bool EspAtDrvClass::checkLinks() {
     tok = strtok(NULL, delim); // <remote port>
     tok = strtok(NULL, delim); // <local port>
     linkInfo[linkId].localPort = atoi(tok);
-#endif
   }
   for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
     LinkInfo& link = linkInfo[linkId];
     if (ok[linkId]) {
       if (!link.isConnected() || link.isClosing()) { // missed incoming connection
-        link.flags = LINK_CONNECTED | LINK_IS_INCOMING;
-        link.incrementSerialId();
+        missedIncomingLink(linkId, link.localPort); // local port from CIPSTATUS
       }
     } else { // not connected
+      if (link.isConnected()) {
+        COUNT_TRAFFIC(syncRecoveries);
+        TRACE(MISSED_CLOSED, linkId, 0);
+        link.events |= LINK_EVENT_CLOSE;
+      }
       link.flags = 0;
     }
   }
   return true;
 }
-#endif
 
 void EspAtDrvClass::printMAC(Print* out, uint8_t* mac) {
   for (int i = 0; i < 6; i++) {
@@ -1981,4 +2916,194 @@ void EspAtDrvClass::printMAC(Print* out, uint8_t* mac) {
   }
 }
 
+#if WIFIESPAT_TRACE_SIZE
+void EspAtDrvClass::trace(EspAtTraceEvent event, uint8_t linkId, uint16_t arg) {
+  TraceRing& ring = checkedTraceRing();
+  EspAtTraceRecord& record = ring.records[ring.head];
+  record.time = micros();
+  record.event = event;
+  record.linkId = linkId;
+  record.arg = arg;
+  if (++ring.head == WIFIESPAT_TRACE_SIZE) {
+    ring.head = 0;
+    ring.wrapped = true;
+  }
+}
+
+uint16_t EspAtDrvClass::traceLength() {
+  TraceRing& ring = checkedTraceRing();
+  return ring.wrapped ? WIFIESPAT_TRACE_SIZE : ring.head;
+}
+
+void EspAtDrvClass::clearTrace() {
+  TraceRing& ring = checkedTraceRing();
+  ring.head = 0;
+  ring.wrapped = false;
+}
+
+bool EspAtDrvClass::traceRecord(uint16_t index, EspAtTraceRecord& record) {
+  if (index >= traceLength())
+    return false;
+  if (traceRing.wrapped) {
+    index = (traceRing.head + index) % WIFIESPAT_TRACE_SIZE;
+  }
+  record = traceRing.records[index];
+  return true;
+}
+
+FSH_P EspAtDrvClass::traceEventName(EspAtTraceEvent event) {
+  switch (event) {
+    case EspAtTraceEvent::RESET:
+      return F("RESET");
+    case EspAtTraceEvent::AT_TIMEOUT:
+      return F("AT_TIMEOUT");
+    case EspAtTraceEvent::AT_ERROR:
+      return F("AT_ERROR");
+    case EspAtTraceEvent::CONNECT:
+      return F("CONNECT");
+    case EspAtTraceEvent::INCOMING:
+      return F("INCOMING");
+    case EspAtTraceEvent::CLOSE:
+      return F("CLOSE");
+    case EspAtTraceEvent::CLOSED:
+      return F("CLOSED");
+    case EspAtTraceEvent::IPD:
+      return F("IPD");
+    case EspAtTraceEvent::IPD_TRUNCATED:
+      return F("IPD_TRUNCATED");
+    case EspAtTraceEvent::UDP_ERROR:
+      return F("UDP_ERROR");
+    case EspAtTraceEvent::SEND:
+      return F("SEND");
+    case EspAtTraceEvent::SEND_FAIL:
+      return F("SEND_FAIL");
+    case EspAtTraceEvent::RECV:
+      return F("RECV");
+    case EspAtTraceEvent::RECV_FAIL:
+      return F("RECV_FAIL");
+    case EspAtTraceEvent::MISSED_IPD:
+      return F("MISSED_IPD");
+    case EspAtTraceEvent::MISSED_CONNECT:
+      return F("MISSED_CONNECT");
+    case EspAtTraceEvent::MISSED_CLOSED:
+      return F("MISSED_CLOSED");
+    default:
+      return F("?");
+  }
+}
+
+/**
+ * decodes the records. one line for every record, oldest first:
+ * <micros> <event> <link or -> <arg>
+ */
+void EspAtDrvClass::printTrace(Print& out) {
+  EspAtTraceRecord record;
+  for (uint16_t i = 0; traceRecord(i, record); i++) {
+    out.print(record.time);
+    out.print(' ');
+    out.print(traceEventName(record.event));
+    out.print(' ');
+    if (record.linkId == NO_LINK) {
+      out.print('-');
+    } else {
+      out.print(record.linkId);
+    }
+    out.print(' ');
+    out.println(record.arg);
+  }
+}
+
+/**
+ * one line for every record, oldest first. 16 hex digits:
+ * micros (8), event (2), link (2), arg (4)
+ */
+void EspAtDrvClass::dumpTrace(Print& out) {
+  EspAtTraceRecord record;
+  for (uint16_t i = 0; traceRecord(i, record); i++) {
+    uint8_t bytes[8] = {(uint8_t) (record.time >> 24), (uint8_t) (record.time >> 16), (uint8_t) (record.time >> 8),
+        (uint8_t) record.time, (uint8_t) record.event, record.linkId, (uint8_t) (record.arg >> 8), (uint8_t) record.arg};
+    for (uint8_t j = 0; j < 8; j++) {
+      if (bytes[j] < 16) {
+        out.print('0');
+      }
+      out.print(bytes[j], HEX);
+    }
+    out.println();
+  }
+}
+#endif
+
+#if WIFIESPAT_TRAFFIC_STATS
+void EspAtDrvClass::resetTrafficStats() {
+  trafficStats = EspAtTrafficStats();
+  for (int linkId = 0; linkId < LINKS_COUNT; linkId++) {
+    linkInfo[linkId].stats = EspAtLinkStats();
+  }
+}
+#endif
+
+#if WIFIESPAT_CMD_STATS
+void EspAtDrvClass::cmdStatsEnd() {
+  if (!cmdStatsPrint.running)
+    return;
+  cmdStatsPrint.running = false;
+  uint32_t time = micros() - cmdStatsPrint.start;
+  cmdStatsPrint.name[cmdStatsPrint.length] = 0;
+  uint8_t type = 0;
+  if (cmdStatsPrint.length > strlen("AT+")) {
+    for (; type < CMD_TYPES_COUNT - 1; type++) { // OTHER is last
+      PGM_P typeName = (PGM_P) cmdTypeName((EspAtCmdType) type);
+      if (strncmp_P(cmdStatsPrint.name + strlen("AT+"), typeName, strlen_P(typeName)) == 0) // startsWith
+        break;
+    }
+  } else {
+    type = (uint8_t) EspAtCmdType::OTHER;
+  }
+  EspAtCmdStats& stats = cmdStatsTable[type];
+  if (stats.count == 0 || time < stats.minTime) {
+    stats.minTime = time;
+  }
+  if (time > stats.maxTime) {
+    stats.maxTime = time;
+  }
+  stats.count++;
+  uint8_t bucket = 0;
+  while (bucket < CMD_STATS_BUCKETS_COUNT - 1 && time >= CMD_STATS_BUCKET_LIMITS[bucket] * 1000UL) {
+    bucket++;
+  }
+  if (stats.buckets[bucket] < 0xFFFF) {
+    stats.buckets[bucket]++;
+  }
+}
+
+void EspAtDrvClass::resetCmdStats() {
+  for (uint8_t i = 0; i < CMD_TYPES_COUNT; i++) {
+    cmdStatsTable[i] = EspAtCmdStats();
+  }
+}
+
+void EspAtDrvClass::printCmdStats(Print& out) {
+  for (uint8_t i = 0; i < CMD_TYPES_COUNT; i++) {
+    const EspAtCmdStats& stats = cmdStatsTable[i];
+    if (stats.count == 0)
+      continue;
+    out.print(cmdTypeName((EspAtCmdType) i));
+    out.print(F(" count "));
+    out.print(stats.count);
+    out.print(F(" min "));
+    out.print(stats.minTime);
+    out.print(F(" max "));
+    out.print(stats.maxTime);
+    out.print(F(" us |"));
+    for (uint8_t b = 0; b < CMD_STATS_BUCKETS_COUNT; b++) {
+      out.print(b < CMD_STATS_BUCKETS_COUNT - 1 ? F(" <") : F(" >="));
+      out.print(CMD_STATS_BUCKET_LIMITS[b < CMD_STATS_BUCKETS_COUNT - 1 ? b : b - 1]);
+      out.print(F("ms:"));
+      out.print(stats.buckets[b]);
+    }
+    out.println();
+  }
+}
+#endif
+
 EspAtDrvClass EspAtDrv;
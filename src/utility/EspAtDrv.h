@@ -32,28 +32,61 @@ const uint8_t LINK_CLOSING = (1 << 1);
 const uint8_t LINK_IS_INCOMING = (1 << 2);
 const uint8_t LINK_IS_ACCEPTED = (1 << 3);
 const uint8_t LINK_IS_UDP_LISTNER = (1 << 4);
+const uint8_t LINK_CLOSE_IDLE = (1 << 5);
+const uint8_t LINK_PARKED = (1 << 6); // closed by the sketch, kept open for reuse
 
 const uint8_t INDEX_MASK = 0b111;
 const uint8_t SERIALID_MASK = ~INDEX_MASK;
 
-//#define WIFIESPAT_MULTISERVER
+#ifndef WIFIESPAT_SERVERS_COUNT
+#ifdef WIFIESPAT_MULTISERVER // the former compile time option
+#define WIFIESPAT_SERVERS_COUNT 4
+#else
+#define WIFIESPAT_SERVERS_COUNT 2
+#endif
+#endif
+
+const uint8_t SERVERS_COUNT = WIFIESPAT_SERVERS_COUNT;
+
+#ifndef WIFIESPAT_TCP_KEEP_ALIVE
+#define WIFIESPAT_TCP_KEEP_ALIVE 0 // seconds. 0 is off
+#endif
+
+#ifndef WIFIESPAT_UDP_SENDER_IDLE_TIMEOUT
+#define WIFIESPAT_UDP_SENDER_IDLE_TIMEOUT 10000 // millis
+#endif
+
+struct ServerInfo {
+  uint16_t port = 0; // 0 is unused entry
+  EspAtLinkEventCallback eventCallback = nullptr;
+};
 
 struct LinkInfo {
   uint8_t serialId = 0;
   uint8_t flags = 0;
   size_t available = 0;
-#ifdef WIFIESPAT_MULTISERVER
+  uint8_t events = 0; // not yet fired LINK_EVENT_ bits
+  EspAtLinkEventCallback eventCallback = nullptr;
   uint16_t localPort = 0;
+  unsigned long lastActivity = 0; // millis of connect, data received or sent
+  uint32_t reuseKey = 0; // hash of type, host and port of a client link. 0 is not reusable
+#ifndef WIFIESPAT1
+  uint32_t sslConfigHash = 0; // hash of the EspAtSslConfig applied to the link. 0 is firmware defaults
 #endif
 
 #ifdef WIFIESPAT1
   EspAtDrvUdpDataCallback* udpDataCallback;
 #endif
+#if WIFIESPAT_TRAFFIC_STATS
+  EspAtLinkStats stats;
+#endif
 
   bool isConnected() { return flags & LINK_CONNECTED;}
   bool isClosing() { return flags & LINK_CLOSING;}
   bool isIncoming() { return flags & LINK_IS_INCOMING;}
   bool isUdpListener() { return flags & LINK_IS_UDP_LISTNER;}
+  bool isCloseIdle() { return flags & LINK_CLOSE_IDLE;}
+  bool isParked() { return flags & LINK_PARKED;}
 
   void incrementSerialId() {
     serialId += (INDEX_MASK + 1);
@@ -63,10 +96,11 @@ struct LinkInfo {
 class EspAtDrvClass {
 public:
 
-  bool init(Stream* serial, int8_t resetPin = -1);
+  bool init(Stream* serial, int8_t resetPin = -1, bool warmStart = false); // warmStart adopts the state of running firmware
 
   bool reset(int8_t resetPin = -1);
   void maintain();
+  void processEvents(); // maintain() and fire the link events callbacks
   EspAtDrvError getLastErrorCode() {return lastErrorCode;}
   bool firmwareVersion(char* buff);
   bool sysPersistent(bool persistent);
@@ -75,6 +109,8 @@ public:
   int ethStatus();
 
   uint8_t listAP(WiFiApData apData[], uint8_t size); // returns count of filled records
+  bool startListAP(EspAtApScanCallback callback, const char* ssid = nullptr, uint8_t channel = 0); // doesn't wait
+  bool listAPRunning() {return apScanCallback != nullptr;}
 
   bool setDNS(const IPAddress& dns1, const IPAddress& dns2);
   bool dnsQuery(IPAddress& dns1, IPAddress& dns2);
@@ -84,7 +120,7 @@ public:
   bool staMacQuery(uint8_t* mac);
   bool staIpQuery(IPAddress& ip, IPAddress& gwip, IPAddress& mask);
 
-  bool joinAP(const char* ssid, const char* password, const uint8_t* bssid);
+  bool joinAP(const char* ssid, const char* password, const uint8_t* bssid); // AT2 first tries the last AP of the SSID
   bool joinEAP(const char* ssid, uint8_t method, const char* identity, const char* username, const char* password, uint8_t security);
   bool quitAP(bool save);
   bool staAutoConnect(bool autoConnect);
@@ -110,12 +146,21 @@ public:
   bool serverBegin(uint16_t port, uint8_t maxConnCount = 1, uint16_t serverTimeout = 60, bool ssl = false, bool ca = false);
   bool serverEnd(uint16_t port);
   uint8_t newClientLinkId(uint16_t serverPort);
+  void pollLinks(EspAtLinksState& state, uint16_t serverPort);
+  bool setServerEventCallback(uint16_t port, EspAtLinkEventCallback callback);
+  bool setLinkEventCallback(uint8_t linkId, EspAtLinkEventCallback callback);
+  uint8_t serverLinkIds(uint16_t serverPort, uint8_t linkIds[]); // returns count of accepted links
+  uint8_t idleLinkId(uint16_t serverPort, unsigned long idleTime, bool whenFull);
 
   uint8_t connect(const char* type, const char* host, uint16_t port, //
 #ifdef WIFIESPAT1
       EspAtDrvUdpDataCallback* udpDataCallback = nullptr, 
 #endif      
       uint16_t udpLocalPort = 0);
+  uint8_t connectSSL(const char* host, uint16_t port, const EspAtSslConfig* config);
+  bool setCloseOnIdle(uint8_t linkId); // link is closed after WIFIESPAT_UDP_SENDER_IDLE_TIMEOUT or if a link is needed
+  void setLinkReuseTime(unsigned long time) {linkReuseTime = time;} // 0 disables reuse of closed TCP and SSL links
+  void setTcpKeepAlive(uint16_t seconds) {tcpKeepAlive = seconds;} // for next TCP and SSL connect. 1 to 7200, 0 is off
   bool close(uint8_t linkId, bool abort = false);
 
   uint16_t localPortQuery(uint8_t linkId);
@@ -145,6 +190,25 @@ public:
 
   void ip2str(const IPAddress& ip, char* s);
 
+#if WIFIESPAT_TRACE_SIZE
+  uint16_t traceLength();
+  bool traceRecord(uint16_t index, EspAtTraceRecord& record); // index 0 is the oldest record
+  void printTrace(Print& out);
+  void dumpTrace(Print& out); // records as hex lines for extras/host TraceDecode
+  void clearTrace();
+  static const __FlashStringHelper* traceEventName(EspAtTraceEvent event);
+#endif
+#if WIFIESPAT_TRAFFIC_STATS
+  const EspAtTrafficStats& getTrafficStats() {return trafficStats;}
+  const EspAtLinkStats& getLinkStats(uint8_t linkId) {return linkInfo[linkId & INDEX_MASK].stats;}
+  void resetTrafficStats();
+#endif
+#if WIFIESPAT_CMD_STATS
+  const EspAtCmdStats& cmdStats(EspAtCmdType type) {return cmdStatsTable[(uint8_t) type];}
+  void resetCmdStats();
+  void printCmdStats(Print& out);
+#endif
+
 private:
   Stream* serial;
   Print* cmd; // debug wrapper or serial
@@ -154,11 +218,60 @@ private:
   int8_t wifiModeDef = -1;
   bool ethConnected = false;
   LinkInfo linkInfo[LINKS_COUNT];
+  ServerInfo servers[SERVERS_COUNT];
+  uint8_t acceptQueue[LINKS_COUNT]; // incoming links in order of CONNECT
+  uint8_t acceptQueueLength = 0;
+  bool firingEvents = false;
+  uint16_t warmServerPort = 0; // server found running at warm start
+  bool closingLinks = false; // closeExpiredLinks() is running
+  struct {
+    uint32_t ssidHash = 0; // 0 is not set
+    uint8_t bssid[6];
+    uint8_t channel;
+  } lastAP; // from last apQuery, for fast join
+  EspAtApScanCallback apScanCallback = nullptr; // AP scan started with startListAP is running
+  uint8_t apScanChannel = 0;
+  unsigned long apScanStart = 0;
+  const EspAtSslConfig* sslConfig = nullptr; // for the running connectSSL
+#ifdef WIFIESPAT1
+  uint16_t sslBufferSize = 0; // applied AT+CIPSSLSIZE
+#endif
+  uint16_t tcpKeepAlive = WIFIESPAT_TCP_KEEP_ALIVE;
+  unsigned long linkReuseTime = 0; // millis a closed client link is kept open for connect to same host and port
+  bool dataInfo = false; // AT+CIPDINFO=1 is set. remote IP and port in +IPD and +CIPRECVDATA
   EspAtDrvError lastErrorCode = EspAtDrvError::NOT_INITIALIZED;
   unsigned long lastSyncMillis;
+#if WIFIESPAT_TRAFFIC_STATS
+  EspAtTrafficStats trafficStats;
+#endif
+#if WIFIESPAT_TRACE_SIZE
+  void trace(EspAtTraceEvent event, uint8_t linkId, uint16_t arg); // the ring is in EspAtDrv.cpp
+#endif
+#if WIFIESPAT_CMD_STATS
+  EspAtCmdStats cmdStatsTable[CMD_TYPES_COUNT];
+
+  void cmdStatsEnd(); // records the latency of the last sent command
+#endif
 
   uint8_t freeLinkId();
+  void parseAP(WiFiApData& ap);
+  bool configure();
+  bool warmStart();
+  bool joinAP(const char* ssid, const char* password, const uint8_t* bssid, bool fast);
+  uint32_t linkReuseKey(const char* type, const char* host, uint16_t port, uint32_t sslHash);
+  bool applySslConfig(uint8_t linkId, const EspAtSslConfig* config);
+  uint8_t parkedLinkId(uint32_t reuseKey);
+  bool closeParkedLink(uint8_t linkId = NO_LINK); // NO_LINK closes the longest parked link
+  bool closeIdleLink();
+  void closeExpiredLinks();
   uint8_t checkLinkId(uint8_t linkId);
+  ServerInfo* serverInfo(uint16_t port);
+  uint16_t singleServerPort();
+  uint16_t incomingLinkPort(uint8_t linkId, bool& linksChecked);
+  bool incomingLink(uint8_t linkId, uint16_t localPort);
+  void missedIncomingLink(uint8_t linkId, uint16_t localPort);
+  void acceptQueueAdd(uint8_t linkId);
+  void acceptQueueRemove(uint8_t index);
 
   bool readRX(PGM_P expected, bool bufferData = true, bool listItem = false);
   bool readOK();
@@ -21,11 +21,24 @@
 #define _ESPATDRV_TYPES_H_
 
 #include <Arduino.h>
+#include <IPAddress.h>
 
 #ifndef WIFIESPAT2 // for -D
 #define WIFIESPAT1
 #endif
 
+#ifndef WIFIESPAT_CMD_STATS
+#define WIFIESPAT_CMD_STATS 0 // 1 enables the AT command latency statistics
+#endif
+
+#ifndef WIFIESPAT_TRACE_SIZE
+#define WIFIESPAT_TRACE_SIZE 0 // count of records in the trace ring buffer. 0 disables the trace
+#endif
+
+#ifndef WIFIESPAT_TRAFFIC_STATS
+#define WIFIESPAT_TRAFFIC_STATS 0 // 1 enables the counters of data and transactions for links
+#endif
+
 const uint8_t WIFIESPAT_LINKS_COUNT = 5;
 const uint8_t WIFIESPAT_NO_LINK = 255;
 
@@ -60,6 +73,103 @@ struct WiFiApData {
    uint8_t enc;
 };
 
+// called for every AP found by a running scan. see EspAtDrvClass::startListAP
+typedef void (*EspAtApScanCallback)(const WiFiApData& ap);
+
+// bit masks of links (bit 0 for link 0) filled by one poll of all links
+struct EspAtLinksState {
+  uint8_t incoming = 0; // new not accepted connections
+  uint8_t readable = 0; // data available
+  uint8_t writable = 0; // connected and not closing
+  uint8_t closed = 0;   // not connected or closing
+};
+
+// event bits for EspAtLinkEventCallback
+const uint8_t LINK_EVENT_CONNECT = (1 << 0);
+const uint8_t LINK_EVENT_DATA = (1 << 1);
+const uint8_t LINK_EVENT_CLOSE = (1 << 2);
+
+typedef void (*EspAtLinkEventCallback)(uint8_t linkId, uint8_t events);
+
+// settings applied before SSL connect. see the AT commands reference
+struct EspAtSslConfig {
+  uint16_t bufferSize = 0; // AT1 AT+CIPSSLSIZE 2048 to 4096. 0 for firmware default
+  uint8_t authMode = 0; // AT2 AT+CIPSSLCCONF 0 no auth, 1 client cert, 2 server cert check, 3 both
+  uint8_t pkiNumber = 0; // AT2 AT+CIPSSLCCONF index of the client certificate
+  uint8_t caNumber = 0; // AT2 AT+CIPSSLCCONF index of the CA certificate
+  const char* sni = nullptr; // AT2 AT+CIPSSLCSNI server name indication
+  const char* alpn = nullptr; // AT2 AT+CIPSSLCALPN one application protocol
+};
+
+// events recorded in the trace ring buffer (WIFIESPAT_TRACE_SIZE)
+enum struct EspAtTraceEvent : uint8_t {
+  RESET,
+  AT_TIMEOUT, // arg is the count of timeouts
+  AT_ERROR,
+  CONNECT, // arg is the remote port
+  INCOMING, // arg is the local port
+  CLOSE, // by the sketch. arg 1 is abort
+  CLOSED, // by the remote side or the firmware
+  IPD, // arg is the length of available data
+  IPD_TRUNCATED,
+  UDP_ERROR, // arg is EspAtDrvUdpDataCallback result
+  SEND, // arg is the count of bytes sent
+  SEND_FAIL,
+  RECV, // arg is the count of bytes received
+  RECV_FAIL,
+  MISSED_IPD, // found by the links state polling. arg is the length of available data
+  MISSED_CONNECT, // arg is the local port, 0 if unknown
+  MISSED_CLOSED
+};
+
+struct EspAtTraceRecord {
+  uint32_t time; // micros
+  EspAtTraceEvent event;
+  uint8_t linkId; // WIFIESPAT_NO_LINK if not for a link
+  uint16_t arg;
+};
+
+// traffic counters of a link since start or resetTrafficStats() (WIFIESPAT_TRAFFIC_STATS)
+struct EspAtLinkStats {
+  uint32_t bytesSent = 0;
+  uint32_t bytesReceived = 0;
+  uint32_t sendCount = 0; // successful AT+CIPSEND transactions
+  uint32_t recvCount = 0; // successful AT+CIPRECVDATA transactions
+  uint32_t partialSends = 0; // the firmware took less bytes than requested
+  uint32_t sendFails = 0;
+  uint32_t ipdCount = 0; // +IPD notifications
+};
+
+struct EspAtTrafficStats {
+  EspAtLinkStats total; // sum of all links
+  uint32_t truncatedIpd = 0; // +IPD lines ignored after serial buffer overflow
+  uint32_t syncRecoveries = 0; // missed notifications found by polling the links state
+};
+
+// AT command families of the command latency statistics (WIFIESPAT_CMD_STATS)
+enum struct EspAtCmdType : uint8_t {
+  CIPSEND, // with CIPSENDEX, measured until SEND OK
+  CIPRECVDATA,
+  CIPRECVLEN,
+  CIPSTATUS,
+  CIPSTART,
+  CIPCLOSE,
+  CWJAP,
+  CWLAP,
+  OTHER
+};
+
+const uint8_t CMD_TYPES_COUNT = 9;
+const uint8_t CMD_STATS_BUCKETS_COUNT = 8; // < 1, 2, 5, 10, 50, 100, 1000 millis and longer
+
+// latency from sending the command to the expected response
+struct EspAtCmdStats {
+  uint32_t count = 0;
+  uint32_t minTime = 0; // micros
+  uint32_t maxTime = 0; // micros
+  uint16_t buckets[CMD_STATS_BUCKETS_COUNT] = {}; // count of commands in latency range
+};
+
 #ifdef WIFIESPAT1
 class EspAtDrvUdpDataCallback {
 protected:
@@ -69,7 +179,8 @@ protected:
   static const uint8_t LARGE = 2;
   static const uint8_t TIMEOUT = 3;
 
-  virtual uint8_t readRxData(Stream* serial, size_t len) = 0;
+  // remotePort is 0 if the firmware didn't send the remote IP and port
+  virtual uint8_t readRxData(Stream* serial, size_t len, const IPAddress& remoteIP, uint16_t remotePort) = 0;
   friend EspAtDrvClass;
 };
 #endif